@@ -0,0 +1,557 @@
+#include "apiserver.h"
+#include <QThread>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QTimer>
+
+namespace {
+
+const int IdleTimeout = 2000;     // ms a keep-alive connection may sit idle
+const int PollInterval = 250;     // ms between checks for shutdown while a send waits
+const int MaxHeaderSize = 16384;
+const int MaxPageSize = 1000;
+const int MaxCacheEntries = 256;
+const int ExportChunkSize = 64 * 1024;
+const int MaxUnsentChunks = 4;    // per connection, queued but not yet handed to the OS
+
+struct Filter
+{
+    QString where;
+    QVariantList values;
+};
+
+Filter buildFilter(const QUrlQuery &params, const QString &defaultType = QString())
+{
+    QStringList clauses;
+    Filter filter;
+
+    QString type = params.queryItemValue("type");
+    if (type.isEmpty()) type = defaultType;
+    if (!type.isEmpty()) { clauses << "type = ?"; filter.values << type; }
+
+    const QString category = params.queryItemValue("category");
+    if (!category.isEmpty()) { clauses << "category = ?"; filter.values << category; }
+
+    const QString from = params.queryItemValue("from");
+    if (!from.isEmpty()) { clauses << "date >= ?"; filter.values << from; }
+
+    const QString to = params.queryItemValue("to");
+    if (!to.isEmpty()) { clauses << "date <= ?"; filter.values << to; }
+
+    if (!clauses.isEmpty()) filter.where = " WHERE " + clauses.join(" AND ");
+    return filter;
+}
+
+bool execFiltered(QSqlQuery &query, const QString &sql, const Filter &filter, const QVariantList &extra = {})
+{
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) return false;
+    for (const QVariant &value : filter.values) query.addBindValue(value);
+    for (const QVariant &value : extra) query.addBindValue(value);
+    return query.exec();
+}
+
+QByteArray csvField(const QString &value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n')) return value.toUtf8();
+    QString quoted = value;
+    quoted.replace("\"", "\"\"");
+    return '"' + quoted.toUtf8() + '"';
+}
+
+// Cache key for an aggregate: the endpoint plus the filter it resolved to,
+// so parameter order, unknown parameters and paging never add entries.
+QString cacheKey(const QString &path, const Filter &filter)
+{
+    QStringList parts{path, filter.where};
+    for (const QVariant &value : filter.values) parts << value.toString();
+    return parts.join(QChar(0x1f));
+}
+
+QByteArray httpResponse(int status, const QByteArray &contentType, const QByteArray &body, bool keepAlive)
+{
+    static const QHash<int, QByteArray> reasons = {
+        {200, "OK"}, {400, "Bad Request"}, {404, "Not Found"}, {405, "Method Not Allowed"},
+        {413, "Payload Too Large"}, {431, "Request Header Fields Too Large"},
+        {500, "Internal Server Error"}, {503, "Service Unavailable"}};
+
+    return "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasons.value(status) + "\r\n"
+           "Content-Type: " + contentType + "\r\n"
+           "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+           "Connection: " + (keepAlive ? "keep-alive" : "close") + "\r\n\r\n" + body;
+}
+
+QByteArray errorResponse(int status, const QString &message, bool keepAlive)
+{
+    QJsonObject error{{"error", message}};
+    return httpResponse(status, "application/json", QJsonDocument(error).toJson(QJsonDocument::Compact), keepAlive);
+}
+
+// One client socket. Lives on the server thread and parses requests as
+// bytes arrive; a complete request goes to the query pool, one at a time.
+// Between requests the connection holds no pool thread.
+class ApiConnection : public QObject
+{
+public:
+    ApiConnection(ApiServer *server, QThreadPool *pool, qintptr descriptor);
+
+    // Called from the pool thread serving the current request. send()
+    // returns false once the client is gone.
+    bool send(const QByteArray &data);
+    void finish(bool keepAlive);
+
+    void abort();
+
+private:
+    void readRequests();
+    void reject(int status, const QString &message);
+    void releaseCredits();
+    void closed();
+
+    ApiServer *m_server;
+    QThreadPool *m_pool;
+    QTcpSocket *m_socket;
+    QTimer *m_idle;
+    QByteArray m_buffer;
+    bool m_busy = false;
+    int m_heldCredits = 0;
+    QSemaphore m_credits{MaxUnsentChunks};
+    std::atomic<bool> m_closed{false};
+};
+
+class ApiRequest : public QRunnable
+{
+public:
+    ApiRequest(ApiServer *server, ApiConnection *connection, const QByteArray &method,
+               const QByteArray &target, bool keepAlive)
+        : m_server(server), m_connection(connection), m_method(method), m_target(target), m_keepAlive(keepAlive) {}
+
+    void run() override;
+
+private:
+    void respond(int status, const QByteArray &contentType, const QByteArray &body);
+    void respondJson(const QJsonDocument &doc) { respond(200, "application/json", doc.toJson(QJsonDocument::Compact)); }
+    void respondError(int status, const QString &message);
+
+    void handle();
+    void serveSummary();
+    void serveCategories(const QUrlQuery &params);
+    void serveTransactions(const QUrlQuery &params);
+    void serveExport(const QUrlQuery &params);
+
+    ApiServer *m_server;
+    ApiConnection *m_connection;
+    QByteArray m_method;
+    QByteArray m_target;
+    QSqlDatabase m_db;
+    bool m_keepAlive;
+};
+
+ApiConnection::ApiConnection(ApiServer *server, QThreadPool *pool, qintptr descriptor)
+    : QObject(server), m_server(server), m_pool(pool),
+      m_socket(new QTcpSocket(this)), m_idle(new QTimer(this))
+{
+    m_idle->setSingleShot(true);
+    m_idle->setInterval(IdleTimeout);
+    m_socket->setReadBufferSize(MaxHeaderSize);
+    connect(m_idle, &QTimer::timeout, m_socket, &QTcpSocket::disconnectFromHost);
+    connect(m_socket, &QTcpSocket::readyRead, this, [this] { readRequests(); });
+    connect(m_socket, &QTcpSocket::bytesWritten, this, [this] { releaseCredits(); });
+    connect(m_socket, &QTcpSocket::disconnected, this, [this] { closed(); });
+
+    if (!m_socket->setSocketDescriptor(descriptor)) {
+        m_closed = true;
+        deleteLater();
+        return;
+    }
+    m_idle->start();
+}
+
+void ApiConnection::readRequests()
+{
+    if (m_closed) {
+        m_socket->readAll(); // discarded; the connection is on its way out
+        return;
+    }
+    // Leave further bytes in the socket while a request runs; with the read
+    // buffer capped, a client that keeps sending is held back by TCP.
+    if (m_busy) return; // picked up again when the current request finishes
+    m_buffer += m_socket->readAll();
+
+    const qsizetype headerEnd = m_buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (m_buffer.size() > MaxHeaderSize) reject(431, "Request header too large");
+        return;
+    }
+
+    const QList<QByteArray> lines = m_buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3) {
+        reject(400, "Malformed request line");
+        return;
+    }
+
+    bool keepAlive = requestLine[2] == "HTTP/1.1";
+    qsizetype contentLength = 0;
+    for (qsizetype i = 1; i < lines.size(); ++i) {
+        const QByteArray line = lines[i].trimmed();
+        const qsizetype colon = line.indexOf(':');
+        if (colon < 0) continue;
+        const QByteArray name = line.left(colon).trimmed().toLower();
+        const QByteArray value = line.mid(colon + 1).trimmed().toLower();
+        if (name == "connection") keepAlive = (value == "keep-alive");
+        else if (name == "content-length") contentLength = qMax(0LL, value.toLongLong());
+    }
+
+    // Nothing here takes a body; wait for a small one and skip over it.
+    if (contentLength > MaxHeaderSize) {
+        reject(413, "Request body not accepted");
+        return;
+    }
+    const qsizetype requestSize = headerEnd + 4 + contentLength;
+    if (m_buffer.size() < requestSize) return;
+    m_buffer.remove(0, requestSize);
+
+    m_busy = true;
+    m_idle->stop();
+    m_pool->start(new ApiRequest(m_server, this, requestLine[0], requestLine[1], keepAlive));
+}
+
+void ApiConnection::reject(int status, const QString &message)
+{
+    m_closed = true;
+    m_socket->write(errorResponse(status, message, false));
+    m_socket->disconnectFromHost();
+}
+
+bool ApiConnection::send(const QByteArray &data)
+{
+    // Bound what sits unsent in memory when the client reads more slowly
+    // than the query produces rows.
+    while (!m_credits.tryAcquire(1, PollInterval)) {
+        if (m_closed || m_server->isStopping()) return false;
+    }
+    if (m_closed) return false;
+    QMetaObject::invokeMethod(this, [this, data] {
+        ++m_heldCredits;
+        if (m_socket->state() == QAbstractSocket::ConnectedState) m_socket->write(data);
+        releaseCredits();
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void ApiConnection::releaseCredits()
+{
+    if (m_heldCredits > 0 && m_socket->bytesToWrite() < ExportChunkSize) {
+        m_credits.release(m_heldCredits);
+        m_heldCredits = 0;
+    }
+}
+
+void ApiConnection::finish(bool keepAlive)
+{
+    QMetaObject::invokeMethod(this, [this, keepAlive] {
+        m_busy = false;
+        if (m_socket->state() == QAbstractSocket::UnconnectedState) {
+            deleteLater();
+        } else if (!keepAlive || m_closed) {
+            m_closed = true;
+            m_socket->disconnectFromHost();
+        } else {
+            m_idle->start();
+            if (!m_buffer.isEmpty() || m_socket->bytesAvailable() > 0) readRequests();
+        }
+    }, Qt::QueuedConnection);
+}
+
+void ApiConnection::closed()
+{
+    m_closed = true;
+    m_credits.release(MaxUnsentChunks); // wakes a worker waiting in send()
+    if (!m_busy) deleteLater();
+}
+
+void ApiConnection::abort()
+{
+    m_closed = true;
+    m_credits.release(MaxUnsentChunks);
+    m_socket->abort();
+}
+
+void ApiRequest::run()
+{
+    m_db = QSqlDatabase::database(m_server->readerConnection());
+    handle();
+    m_db = QSqlDatabase();
+    m_connection->finish(m_keepAlive);
+}
+
+void ApiRequest::respond(int status, const QByteArray &contentType, const QByteArray &body)
+{
+    if (!m_connection->send(httpResponse(status, contentType, body, m_keepAlive))) m_keepAlive = false;
+}
+
+void ApiRequest::respondError(int status, const QString &message)
+{
+    if (!m_connection->send(errorResponse(status, message, m_keepAlive))) m_keepAlive = false;
+}
+
+void ApiRequest::handle()
+{
+    if (m_method != "GET") {
+        respondError(405, "Only GET is supported");
+        return;
+    }
+
+    const QUrl url(QString::fromUtf8(m_target));
+    const QString path = url.path();
+    const QUrlQuery params(url);
+
+    if (path == "/summary") serveSummary();
+    else if (path == "/categories") serveCategories(params);
+    else if (path == "/transactions") serveTransactions(params);
+    else if (path == "/export.csv") serveExport(params);
+    else respondError(404, "Unknown endpoint " + path);
+}
+
+void ApiRequest::serveSummary()
+{
+    const QString key = cacheKey("/summary", Filter());
+    QByteArray body = m_server->cachedResponse(key);
+    if (body.isEmpty()) {
+        const quint64 generation = m_server->generation();
+        QSqlQuery query(m_db);
+        if (!execFiltered(query, "SELECT type, SUM(amount), COUNT(*) FROM transactions GROUP BY type", Filter())) {
+            respondError(500, query.lastError().text());
+            return;
+        }
+        double income = 0, expense = 0;
+        qint64 count = 0;
+        while (query.next()) {
+            if (query.value(0).toString() == "Income") income += query.value(1).toDouble();
+            else expense += query.value(1).toDouble();
+            count += query.value(2).toLongLong();
+        }
+        QJsonObject summary{{"income", income}, {"expense", expense},
+                            {"balance", income - expense}, {"count", count}};
+        body = QJsonDocument(summary).toJson(QJsonDocument::Compact);
+        m_server->storeResponse(key, body, generation);
+    }
+    respond(200, "application/json", body);
+}
+
+void ApiRequest::serveCategories(const QUrlQuery &params)
+{
+    const Filter filter = buildFilter(params, "Expense");
+    const QString key = cacheKey("/categories", filter);
+    QByteArray body = m_server->cachedResponse(key);
+    if (body.isEmpty()) {
+        const quint64 generation = m_server->generation();
+        QSqlQuery query(m_db);
+        if (!execFiltered(query, "SELECT category, SUM(amount), COUNT(*) FROM transactions" + filter.where
+                                     + " GROUP BY category ORDER BY 2 DESC", filter)) {
+            respondError(500, query.lastError().text());
+            return;
+        }
+        QJsonArray categories;
+        while (query.next()) {
+            categories.append(QJsonObject{{"category", query.value(0).toString()},
+                                          {"total", query.value(1).toDouble()},
+                                          {"count", query.value(2).toLongLong()}});
+        }
+        body = QJsonDocument(categories).toJson(QJsonDocument::Compact);
+        m_server->storeResponse(key, body, generation);
+    }
+    respond(200, "application/json", body);
+}
+
+void ApiRequest::serveTransactions(const QUrlQuery &params)
+{
+    const int page = qMax(1, params.queryItemValue("page").toInt());
+    const int limit = qBound(1, params.hasQueryItem("limit") ? params.queryItemValue("limit").toInt() : 50, MaxPageSize);
+    const Filter filter = buildFilter(params);
+
+    QSqlQuery count(m_db);
+    if (!execFiltered(count, "SELECT COUNT(*) FROM transactions" + filter.where, filter) || !count.next()) {
+        respondError(500, count.lastError().text());
+        return;
+    }
+    const qint64 total = count.value(0).toLongLong();
+
+    QSqlQuery query(m_db);
+    if (!execFiltered(query, "SELECT id, date, type, category, amount, description FROM transactions" + filter.where
+                                 + " ORDER BY date DESC, id DESC LIMIT ? OFFSET ?",
+                      filter, {limit, qint64(page - 1) * limit})) {
+        respondError(500, query.lastError().text());
+        return;
+    }
+
+    QJsonArray items;
+    while (query.next()) {
+        items.append(QJsonObject{{"id", query.value(0).toLongLong()},
+                                 {"date", query.value(1).toString()},
+                                 {"type", query.value(2).toString()},
+                                 {"category", query.value(3).toString()},
+                                 {"amount", query.value(4).toDouble()},
+                                 {"description", query.value(5).toString()}});
+    }
+    respondJson(QJsonDocument(QJsonObject{{"page", page}, {"limit", limit}, {"total", total}, {"items", items}}));
+}
+
+void ApiRequest::serveExport(const QUrlQuery &params)
+{
+    const Filter filter = buildFilter(params);
+    QSqlQuery query(m_db);
+    if (!execFiltered(query, "SELECT date, type, category, amount, description FROM transactions" + filter.where
+                                 + " ORDER BY date", filter)) {
+        respondError(500, query.lastError().text());
+        return;
+    }
+
+    QByteArray chunk = QByteArray("HTTP/1.1 200 OK\r\n"
+                                  "Content-Type: text/csv; charset=utf-8\r\n"
+                                  "Transfer-Encoding: chunked\r\n"
+                                  "Connection: ") + (m_keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+    if (!m_connection->send(chunk)) {
+        m_keepAlive = false;
+        return;
+    }
+
+    chunk = "Date,Type,Category,Amount,Description\n";
+    auto writeChunk = [this, &chunk] {
+        const bool sent = m_connection->send(QByteArray::number(chunk.size(), 16) + "\r\n" + chunk + "\r\n");
+        chunk.clear();
+        if (!sent) m_keepAlive = false;
+        return sent;
+    };
+
+    while (query.next()) {
+        chunk += query.value(0).toString().toUtf8() + ',' + csvField(query.value(1).toString()) + ','
+                 + csvField(query.value(2).toString()) + ',' + QByteArray::number(query.value(3).toDouble(), 'f', 2) + ','
+                 + csvField(query.value(4).toString()) + '\n';
+        if (chunk.size() >= ExportChunkSize && !writeChunk()) return;
+    }
+    if (!chunk.isEmpty() && !writeChunk()) return;
+    if (!m_connection->send("0\r\n\r\n")) m_keepAlive = false;
+}
+
+} // namespace
+
+// Owned by the pool thread that opened it; deleted, and the connection
+// removed, on that thread as it exits.
+struct ApiServer::ReaderConnection
+{
+    QString name;
+
+    ~ReaderConnection()
+    {
+        QSqlDatabase::database(name, false).close();
+        QSqlDatabase::removeDatabase(name);
+    }
+};
+
+ApiServer::ApiServer(const QString &databaseName)
+    : m_databaseName(databaseName),
+      m_thread(new QThread),
+      m_generation(0),
+      m_stopping(false)
+{
+    m_pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+
+    m_thread->setObjectName(QStringLiteral("ApiServer"));
+    moveToThread(m_thread);
+    m_thread->start();
+}
+
+ApiServer::~ApiServer()
+{
+    m_stopping = true;
+    QMetaObject::invokeMethod(this, [this] {
+        close();
+        for (QObject *connection : std::as_const(m_connections)) static_cast<ApiConnection *>(connection)->abort();
+    }, Qt::BlockingQueuedConnection);
+
+    // Also ends the pool threads, which closes their reader connections.
+    m_pool.waitForDone();
+
+    QMetaObject::invokeMethod(this, [this] {
+        const QSet<QObject *> connections = m_connections;
+        qDeleteAll(connections);
+    }, Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+}
+
+bool ApiServer::start(quint16 port)
+{
+    bool ok = false;
+    QMetaObject::invokeMethod(this, [this, port, &ok] { ok = listen(QHostAddress::LocalHost, port); },
+                              Qt::BlockingQueuedConnection);
+    return ok;
+}
+
+void ApiServer::invalidateCache()
+{
+    QWriteLocker lock(&m_cacheLock);
+    ++m_generation;
+    m_cache.clear();
+}
+
+QByteArray ApiServer::cachedResponse(const QString &key) const
+{
+    QReadLocker lock(&m_cacheLock);
+    return m_cache.value(key);
+}
+
+void ApiServer::storeResponse(const QString &key, const QByteArray &body, quint64 generation)
+{
+    QWriteLocker lock(&m_cacheLock);
+    // A write landed while this was computed; the result may already be stale.
+    if (generation != m_generation.load()) return;
+    if (m_cache.size() >= MaxCacheEntries && !m_cache.contains(key)) m_cache.erase(m_cache.begin());
+    m_cache.insert(key, body);
+}
+
+QString ApiServer::readerConnection()
+{
+    if (m_readers.hasLocalData()) return m_readers.localData()->name;
+
+    const QString name = QString("finance_reader_%1").arg(quintptr(QThread::currentThreadId()));
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(m_databaseName);
+    db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+    db.open();
+
+    m_readers.setLocalData(new ReaderConnection{name});
+    return name;
+}
+
+void ApiServer::incomingConnection(qintptr socketDescriptor)
+{
+    if (m_connections.size() >= MaxConnections || m_stopping) {
+        QTcpSocket *socket = new QTcpSocket(this);
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        if (!socket->setSocketDescriptor(socketDescriptor)) {
+            delete socket;
+            return;
+        }
+        socket->write(errorResponse(503, "Too many connections", false));
+        socket->disconnectFromHost();
+        return;
+    }
+
+    ApiConnection *connection = new ApiConnection(this, &m_pool, socketDescriptor);
+    m_connections.insert(connection);
+    connect(connection, &QObject::destroyed, this, [this, connection] { m_connections.remove(connection); });
+}
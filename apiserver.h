@@ -0,0 +1,66 @@
+#ifndef APISERVER_H
+#define APISERVER_H
+
+#include <QTcpServer>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <atomic>
+
+class QThread;
+
+// Read-only HTTP/JSON view of finance.db for local dashboards and scripts.
+// Sockets are accepted and read on the server's own thread; each parsed
+// request runs on a small query pool where every worker holds a read-only
+// SQLite connection, so neither the GUI nor an idle keep-alive client ties
+// up a worker. At most MaxConnections clients are served at once; further
+// ones get 503. Aggregates are cached per filter until invalidateCache().
+//
+//   GET /summary
+//   GET /categories?type=Expense&from=&to=
+//   GET /transactions?page=1&limit=50&type=&category=&from=&to=
+//   GET /export.csv?type=&category=&from=&to=
+class ApiServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    static const int MaxConnections = 64;
+
+    explicit ApiServer(const QString &databaseName);
+    ~ApiServer();
+
+    bool start(quint16 port);
+    void invalidateCache();
+
+    // Used by the request workers.
+    QByteArray cachedResponse(const QString &key) const;
+    void storeResponse(const QString &key, const QByteArray &body, quint64 generation);
+    quint64 generation() const { return m_generation.load(); }
+    bool isStopping() const { return m_stopping.load(); }
+    QString readerConnection();
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+    struct ReaderConnection;
+
+    QString m_databaseName;
+    QThread *m_thread;
+    QSet<QObject *> m_connections; // server thread only
+
+    // Declared before the pool so it outlives the pool threads; each one
+    // closes its own reader connection as it exits.
+    QThreadStorage<ReaderConnection *> m_readers;
+    QThreadPool m_pool;
+
+    std::atomic<quint64> m_generation;
+    std::atomic<bool> m_stopping;
+    mutable QReadWriteLock m_cacheLock;
+    QHash<QString, QByteArray> m_cache;
+};
+
+#endif // APISERVER_H
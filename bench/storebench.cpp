@@ -0,0 +1,109 @@
+// Loads synthetic transactions the way FInanceTracker::loadTransactions()
+// does and reports what they cost in memory per row.
+//
+//   storebench [rows]    (default 1000000)
+
+#include "ledgerauditor.h"
+#include "transactionmodel.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#elif defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+namespace {
+
+qint64 residentBytes()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return qint64(counters.WorkingSetSize);
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, task_info_t(&info), &count) == KERN_SUCCESS)
+        return qint64(info.resident_size);
+#elif defined(Q_OS_UNIX)
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return -1;
+}
+
+// Rows spread over three years, newest first like the app's query.
+TransactionRecord makeRecord(QRandomGenerator &random, int row, int rows, const QDate &today)
+{
+    static const QStringList categories = {"Food", "Transportation", "Entertainment", "Utilities",
+                                           "Healthcare", "Shopping", "Education", "Other"};
+    static const QStringList merchants = {"Indomaret", "Alfamart", "Grab", "Gojek", "PLN", "Telkomsel",
+                                          "Tokopedia", "Shopee", "Kimia Farma", "Starbucks"};
+
+    TransactionRecord record;
+    record.id = row + 1;
+    record.date = today.addDays(-qint64(row) * 3 * 365 / rows).toString(Qt::ISODate);
+    const bool income = random.bounded(10) == 0;
+    record.type = income ? "Income" : "Expense";
+    record.category = income ? "Salary" : categories[random.bounded(categories.size())];
+    record.amount = (income ? 5000000 : 10000 + random.bounded(500000)) + random.bounded(100) / 100.0;
+    record.description = merchants[random.bounded(merchants.size())] + " #" + QString::number(random.bounded(100000));
+    return record;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const int rows = args.size() > 1 ? qMax(1, args[1].toInt()) : 1000000;
+
+    QTextStream out(stdout);
+    QRandomGenerator random(42);
+    const QDate today = QDate::currentDate();
+
+    const qint64 before = residentBytes();
+    QElapsedTimer timer;
+    timer.start();
+
+    // Same chunking as loadTransactions(), newest first.
+    const int chunkSize = 4096;
+    TransactionModel model;
+    LedgerAuditor auditor;
+    QList<TransactionRecord> chunk;
+    chunk.reserve(chunkSize);
+    for (int done = 0; done < rows; done += chunkSize) {
+        chunk.clear();
+        for (int i = done; i < qMin(rows, done + chunkSize); ++i) chunk.append(makeRecord(random, i, rows, today));
+        model.appendRecords(chunk);
+    }
+    chunk = QList<TransactionRecord>();
+    auditor.rebuild(model.store());
+    const qint64 loadMs = timer.elapsed();
+    const qint64 after = residentBytes();
+
+    const TransactionStore &store = model.store();
+    out << "rows:               " << store.size() << "\n"
+        << "load time:          " << loadMs << " ms\n"
+        << "store bytes/row:    " << double(store.memoryUsage()) / rows << "\n";
+    if (before >= 0 && after >= 0)
+        out << "resident bytes/row: " << double(after - before) / rows << "\n";
+    else
+        out << "resident bytes/row: unavailable on this platform\n";
+
+    timer.restart();
+    const qsizetype findings = auditor.scan(store).size();
+    out << "audit scan:         " << timer.elapsed() << " ms, " << findings << " findings\n";
+    return 0;
+}
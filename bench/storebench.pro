@@ -0,0 +1,22 @@
+QT       = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = storebench
+INCLUDEPATH += ..
+
+SOURCES += \
+    storebench.cpp \
+    ../ledgerauditor.cpp \
+    ../transactionmodel.cpp \
+    ../transactionstore.cpp
+
+HEADERS += \
+    ../ledgerauditor.h \
+    ../transactionmodel.h \
+    ../transactionrecord.h \
+    ../transactionstore.h \
+    ../wordhash.h
+
+win32: LIBS += -lpsapi
@@ -0,0 +1,247 @@
+#include "categorizer.h"
+#include "wordhash.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QThread>
+#include <QVarLengthArray>
+#include <QtConcurrent/QtConcurrentMap>
+#include <cmath>
+
+namespace {
+
+const qsizetype MinRowsPerThread = 4096;
+
+} // namespace
+
+int Categorizer::categoryId(const QString &category)
+{
+    int id = m_categories.indexOf(category);
+    if (id >= 0) return id;
+    m_categories.append(category);
+    m_categoryTokens.append(0);
+    m_categoryDocs.append(0);
+    return m_categories.size() - 1;
+}
+
+void Categorizer::addKeywordRule(const QString &keyword, const QString &category)
+{
+    // Padding with separators makes the automaton match whole words only.
+    QList<int> symbols{Separator};
+    for (QChar c : keyword) {
+        const int symbol = WordHash::symbolOf(c);
+        if (symbol != Separator || symbols.last() != Separator) symbols.append(symbol);
+    }
+    if (symbols.last() != Separator) symbols.append(Separator);
+    if (symbols.size() < 3) return;
+
+    int node = 0;
+    for (int symbol : std::as_const(symbols)) {
+        if (m_trie[node].next[symbol] < 0) {
+            m_trie[node].next[symbol] = m_trie.size();
+            m_trie.append(TrieNode());
+        }
+        node = m_trie[node].next[symbol];
+    }
+    if (m_trie[node].rule >= 0) return; // first rule for a keyword wins
+
+    m_trie[node].rule = m_ruleCategory.size();
+    m_ruleCategory.append(categoryId(category));
+    m_ruleLength.append(symbols.size());
+}
+
+void Categorizer::addRegexRule(const QString &pattern, const QString &category)
+{
+    QRegularExpression re(pattern, QRegularExpression::CaseInsensitiveOption);
+    if (!re.isValid()) return;
+    re.optimize();
+    m_regexRules.append({re, categoryId(category)});
+}
+
+void Categorizer::loadDefaultRules()
+{
+    const QList<QPair<QString, QStringList>> rules = {
+        {"Food", {"restaurant", "resto", "cafe", "coffee", "kopi", "makan", "warung", "bakery", "gofood",
+                  "grabfood", "shopeefood", "kfc", "mcdonald", "mcd", "starbucks", "pizza", "bakso"}},
+        {"Transport", {"gojek", "goride", "grab", "grabcar", "taxi", "bluebird", "bus", "transjakarta", "krl",
+                       "mrt", "lrt", "kai", "train", "bensin", "fuel", "pertamina", "shell", "parkir",
+                       "parking", "tol", "toll", "flight", "airlines"}},
+        {"Bills", {"pln", "listrik", "electricity", "pdam", "water", "internet", "indihome", "wifi", "pulsa",
+                   "telkomsel", "xl", "bpjs", "insurance", "asuransi", "rent", "sewa", "kos", "cicilan"}},
+        {"Shopping", {"tokopedia", "shopee", "lazada", "blibli", "indomaret", "alfamart", "supermarket",
+                      "hypermart", "mall", "uniqlo", "ikea"}},
+        {"Salary", {"gaji", "salary", "payroll", "bonus", "thr"}},
+        {"Investment", {"dividen", "dividend", "reksadana", "saham", "stock", "bibit", "ajaib", "deposito",
+                        "obligasi", "crypto"}},
+        {"Entertainment", {"netflix", "spotify", "youtube", "disney", "bioskop", "cinema", "xxi", "cgv",
+                           "steam", "playstation", "concert", "konser"}},
+    };
+    for (const auto &rule : rules) {
+        for (const QString &keyword : rule.second) addKeywordRule(keyword, rule.first);
+    }
+
+    // Bank statements glue codes and numbers onto the keyword ("BPJSKES",
+    // "PULSA50000", "CICILAN03/12"), which the whole-word automaton misses.
+    addRegexRule(R"(\bbpjs(kes|tk|kesehatan|ketenagakerjaan)?\d*\b)", "Bills");
+    addRegexRule(R"(\b(pulsa|kuota|paket ?data)\s*\d+)", "Bills");
+    addRegexRule(R"(\b(token ?)?(pln|listrik)\s*\d{6,})", "Bills");
+    addRegexRule(R"(\bcicilan\s*\d+)", "Bills");
+    addRegexRule(R"(\b(va|virtual ?account)\s*\d{10,})", "Bills");
+    addRegexRule(R"(\b(gaji|salary|payroll)\w*)", "Salary");
+}
+
+void Categorizer::train(const QList<QPair<QString, QString>> &examples)
+{
+    for (const auto &example : examples) {
+        if (example.second.isEmpty()) continue;
+        const int category = categoryId(example.second);
+        ++m_categoryDocs[category];
+
+        WordHash::forEachWord(example.first, [&](quint64 hash) {
+            auto it = m_tokenIndex.constFind(hash);
+            int token;
+            if (it == m_tokenIndex.constEnd()) {
+                token = m_tokenCounts.size();
+                m_tokenIndex.insert(hash, token);
+                m_tokenCounts.append(QList<quint32>());
+            } else {
+                token = it.value();
+            }
+            QList<quint32> &counts = m_tokenCounts[token];
+            if (counts.size() <= category) counts.resize(category + 1);
+            ++counts[category];
+            ++m_categoryTokens[category];
+        });
+    }
+}
+
+void Categorizer::trainFromDatabase(const QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.exec("SELECT description, category FROM transactions WHERE description <> ''");
+
+    QList<QPair<QString, QString>> examples;
+    while (query.next()) examples.append({query.value(0).toString(), query.value(1).toString()});
+    train(examples);
+}
+
+void Categorizer::build()
+{
+    // Breadth-first pass computing failure links, then folding them into a
+    // dense transition table so scanning never follows a failure link.
+    const int nodes = m_trie.size();
+    m_delta.fill(0, qsizetype(nodes) * AlphabetSize);
+    m_match.fill(-1, nodes);
+    QList<int> fail(nodes, 0);
+    QList<int> queue;
+    queue.reserve(nodes);
+
+    for (int symbol = 0; symbol < AlphabetSize; ++symbol) {
+        const int child = m_trie[0].next[symbol];
+        m_delta[symbol] = child < 0 ? 0 : child;
+        if (child > 0) queue.append(child);
+    }
+    m_match[0] = m_trie[0].rule;
+
+    for (qsizetype head = 0; head < queue.size(); ++head) {
+        const int node = queue[head];
+        m_match[node] = m_trie[node].rule >= 0 ? m_trie[node].rule : m_match[fail[node]];
+        for (int symbol = 0; symbol < AlphabetSize; ++symbol) {
+            const int child = m_trie[node].next[symbol];
+            const int viaFail = m_delta[fail[node] * AlphabetSize + symbol];
+            if (child < 0) {
+                m_delta[node * AlphabetSize + symbol] = viaFail;
+            } else {
+                m_delta[node * AlphabetSize + symbol] = child;
+                fail[child] = viaFail;
+                queue.append(child);
+            }
+        }
+    }
+
+    const int categories = m_categories.size();
+    const int vocabulary = m_tokenCounts.size();
+    quint64 docs = 0;
+    for (quint32 count : std::as_const(m_categoryDocs)) docs += count;
+
+    m_logPrior.fill(0, categories);
+    m_logLikelihood.fill(0, qsizetype(vocabulary) * categories);
+    for (int c = 0; c < categories; ++c) {
+        m_logPrior[c] = std::log((m_categoryDocs[c] + 1.0) / (docs + categories));
+        const double denominator = double(m_categoryTokens[c]) + vocabulary;
+        for (int t = 0; t < vocabulary; ++t) {
+            const QList<quint32> &counts = m_tokenCounts[t];
+            const quint32 count = c < counts.size() ? counts[c] : 0;
+            m_logLikelihood[qsizetype(t) * categories + c] = std::log((count + 1.0) / denominator);
+        }
+    }
+}
+
+QString Categorizer::categorize(const QString &description) const
+{
+    // Keyword rules: one pass through the automaton, longest keyword wins.
+    int state = m_delta.isEmpty() ? -1 : m_delta[Separator];
+    int bestRule = -1;
+    if (state >= 0) {
+        int previous = Separator;
+        auto feed = [&](int symbol) {
+            state = m_delta[state * AlphabetSize + symbol];
+            const int rule = m_match[state];
+            if (rule >= 0 && (bestRule < 0 || m_ruleLength[rule] > m_ruleLength[bestRule])) bestRule = rule;
+        };
+        for (QChar c : description) {
+            const int symbol = WordHash::symbolOf(c);
+            if (symbol == Separator && previous == Separator) continue;
+            feed(symbol);
+            previous = symbol;
+        }
+        if (previous != Separator) feed(Separator);
+    }
+    if (bestRule >= 0) return m_categories[m_ruleCategory[bestRule]];
+
+    for (const auto &rule : m_regexRules) {
+        if (rule.first.match(description).hasMatch()) return m_categories[rule.second];
+    }
+
+    if (m_logPrior.isEmpty()) return QString();
+    const int categories = m_categories.size();
+    QVarLengthArray<float, 16> scores(m_logPrior.constBegin(), m_logPrior.constEnd());
+    bool known = false;
+    WordHash::forEachWord(description, [&](quint64 hash) {
+        const int token = m_tokenIndex.value(hash, -1);
+        if (token < 0) return;
+        known = true;
+        const float *row = m_logLikelihood.constData() + qsizetype(token) * categories;
+        for (int c = 0; c < categories; ++c) scores[c] += row[c];
+    });
+    if (!known) return QString();
+
+    int best = 0;
+    for (int c = 1; c < categories; ++c) {
+        if (scores[c] > scores[best]) best = c;
+    }
+    return m_categories[best];
+}
+
+QStringList Categorizer::categorizeBatch(const QStringList &descriptions) const
+{
+    QStringList result(descriptions.size());
+    const qsizetype threads = qBound<qsizetype>(1, descriptions.size() / MinRowsPerThread,
+                                                QThread::idealThreadCount());
+    if (threads == 1) {
+        for (qsizetype i = 0; i < descriptions.size(); ++i) result[i] = categorize(descriptions[i]);
+        return result;
+    }
+
+    // Each slice writes a disjoint range of the pre-sized result.
+    QList<QPair<qsizetype, qsizetype>> slices;
+    const qsizetype step = (descriptions.size() + threads - 1) / threads;
+    for (qsizetype begin = 0; begin < descriptions.size(); begin += step)
+        slices.append({begin, qMin(begin + step, descriptions.size())});
+
+    QString *out = result.data();
+    QtConcurrent::blockingMap(slices, [this, &descriptions, out](const QPair<qsizetype, qsizetype> &slice) {
+        for (qsizetype i = slice.first; i < slice.second; ++i) out[i] = categorize(descriptions[i]);
+    });
+    return result;
+}
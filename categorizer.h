@@ -0,0 +1,71 @@
+#ifndef CATEGORIZER_H
+#define CATEGORIZER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QPair>
+#include <QRegularExpression>
+#include <array>
+
+class QSqlDatabase;
+
+// Guesses a category from a transaction description. Keyword rules are
+// matched as whole words by one Aho-Corasick automaton, then regex rules are
+// tried in order, and a naive Bayes model trained on the existing ledger
+// covers the rest. Letters and digits are compared case-insensitively;
+// every other character (including non-ASCII) separates words.
+//
+// Add rules and train, then call build(). After that the object is
+// read-only and categorize()/categorizeBatch() may run on any thread.
+class Categorizer
+{
+public:
+    void addKeywordRule(const QString &keyword, const QString &category);
+    void addRegexRule(const QString &pattern, const QString &category);
+    void loadDefaultRules();
+
+    void train(const QList<QPair<QString, QString>> &examples); // description, category
+    void trainFromDatabase(const QSqlDatabase &db);
+
+    void build();
+
+    // Empty when nothing matched and the model has never seen any of the words.
+    QString categorize(const QString &description) const;
+    QStringList categorizeBatch(const QStringList &descriptions) const;
+
+private:
+    static const int AlphabetSize = 37; // a-z, 0-9, separator
+    static const int Separator = 36;    // WordHash::Separator
+
+    struct TrieNode
+    {
+        std::array<int, AlphabetSize> next;
+        int rule = -1;
+        TrieNode() { next.fill(-1); }
+    };
+
+    int categoryId(const QString &category);
+
+    QStringList m_categories;
+
+    // Keyword automaton
+    QList<TrieNode> m_trie{TrieNode()};
+    QList<int> m_ruleCategory;
+    QList<int> m_ruleLength;
+    QList<int> m_delta; // node * AlphabetSize + symbol -> node
+    QList<int> m_match; // longest rule ending at node, or -1
+
+    QList<QPair<QRegularExpression, int>> m_regexRules;
+
+    // Naive Bayes
+    QHash<quint64, int> m_tokenIndex;
+    QList<QList<quint32>> m_tokenCounts; // per token, per category
+    QList<quint64> m_categoryTokens;
+    QList<quint32> m_categoryDocs;
+    QList<float> m_logLikelihood;        // token * categories + category
+    QList<float> m_logPrior;
+};
+
+#endif // CATEGORIZER_H
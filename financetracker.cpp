@@ -1,4 +1,6 @@
 #include "financetracker.h"
+#include "apiserver.h"
+#include "categorizer.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -9,10 +11,47 @@
 #include <QHeaderView>
 #include <QFileDialog>
 #include <QTextStream>
-#include <QLocale>
+#include <QApplication>
+#include <algorithm>
+#include <QStatusBar>
+#include <QSet>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+
+// Splits one CSV line, honouring double-quoted fields.
+QStringList splitCsvLine(const QString &line)
+{
+    QStringList fields;
+    QString field;
+    bool quoted = false;
+    for (qsizetype i = 0; i < line.size(); ++i) {
+        const QChar c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') { field += '"'; ++i; }
+            else if (c == '"') quoted = false;
+            else field += c;
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.append(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.append(field);
+    return fields;
+}
+
+} // namespace
 
 FInanceTracker::FInanceTracker(QWidget *parent)
-    : QMainWindow(parent), totalIncome(0), totalExpense(0)
+    : QMainWindow(parent), writeQueue(nullptr), apiServer(nullptr),
+      importFirstTicket(0), importEndTicket(0),
+      projectionRebuilding(false), projectionRebuildPending(false), projecting(false), projectionPending(false),
+      totalIncome(0), totalExpense(0)
 {
     setupDatabase();
     setupUI();
@@ -23,6 +62,8 @@ FInanceTracker::FInanceTracker(QWidget *parent)
 
 FInanceTracker::~FInanceTracker()
 {
+    delete apiServer;
+    delete writeQueue; // flushes whatever is still queued
     if (db.isOpen()) db.close();
 }
 
@@ -37,14 +78,25 @@ void FInanceTracker::setupDatabase()
     }
 
     QSqlQuery query;
+    query.exec("PRAGMA journal_mode=WAL");
     query.exec("CREATE TABLE IF NOT EXISTS transactions ("
                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                "date TEXT, type TEXT, category TEXT, amount REAL, description TEXT)");
+
+    writeQueue = new WriteQueue(db.databaseName(), this);
+    connect(writeQueue, &WriteQueue::committed, this, &FInanceTracker::onWritesCommitted);
+    connect(writeQueue, &WriteQueue::failed, this, &FInanceTracker::onWritesFailed);
+}
+
+bool FInanceTracker::startApiServer(quint16 port)
+{
+    if (!db.isOpen()) return false;
+    if (!apiServer) apiServer = new ApiServer(db.databaseName());
+    return apiServer->start(port);
 }
 
 QString FInanceTracker::formatRupiah(double amount) {
-    QLocale idr(QLocale::Indonesian, QLocale::Indonesia);
-    return idr.toCurrencyString(amount, "Rp");
+    return TransactionModel::formatRupiah(amount);
 }
 
 void FInanceTracker::setupUI()
@@ -59,8 +111,9 @@ void FInanceTracker::setupUI()
         "QLineEdit, QComboBox, QDateEdit { background-color: #1e1e1e; color: white; border: 1px solid #333; padding: 6px; border-radius: 4px; }"
         "QPushButton { background-color: #0078d4; color: white; border-radius: 4px; padding: 8px; font-weight: bold; }"
         "QPushButton:hover { background-color: #005a9e; }"
-        "QTableWidget { background-color: #1e1e1e; color: white; gridline-color: #333; border-radius: 8px; }"
+        "QTableView { background-color: #1e1e1e; color: white; gridline-color: #333; border-radius: 8px; }"
         "QHeaderView::section { background-color: #252525; color: white; padding: 5px; border: 1px solid #121212; }"
+        "QStatusBar { color: #bbb; }"
         );
 
     QWidget *centralWidget = new QWidget(this);
@@ -126,15 +179,74 @@ void FInanceTracker::setupUI()
     chartView = new QChartView(pieChart);
     chartView->setRenderHint(QPainter::Antialiasing);
     chartView->setFixedHeight(280);
-    mainLayout->addWidget(chartView);
+
+    // Forecast
+    QGroupBox *forecastGroup = new QGroupBox("Balance Forecast");
+    QVBoxLayout *forecastLayout = new QVBoxLayout();
+    QHBoxLayout *forecastControls = new QHBoxLayout();
+
+    horizonSpin = new QSpinBox();
+    horizonSpin->setRange(3, ProjectionEngine::MaxMonths);
+    horizonSpin->setValue(12);
+    horizonSpin->setSuffix(" months");
+    incomeSlider = new QSlider(Qt::Horizontal);
+    incomeSlider->setRange(-50, 50);
+    expenseSlider = new QSlider(Qt::Horizontal);
+    expenseSlider->setRange(-50, 50);
+    incomeSliderLabel = new QLabel("Income +0%");
+    expenseSliderLabel = new QLabel("Expenses +0%");
+
+    forecastControls->addWidget(horizonSpin);
+    forecastControls->addWidget(incomeSliderLabel);
+    forecastControls->addWidget(incomeSlider);
+    forecastControls->addWidget(expenseSliderLabel);
+    forecastControls->addWidget(expenseSlider);
+
+    forecastChart = new QChart();
+    forecastChart->setBackgroundVisible(false);
+    forecastChart->legend()->hide();
+    forecastLow = new QLineSeries(this);
+    forecastHigh = new QLineSeries(this);
+    forecastMedian = new QLineSeries();
+    QAreaSeries *forecastBand = new QAreaSeries(forecastHigh, forecastLow);
+    forecastBand->setColor(QColor(0, 120, 212, 90));
+    forecastBand->setPen(Qt::NoPen);
+    forecastMedian->setPen(QPen(QColor("#4caf50"), 2));
+    forecastChart->addSeries(forecastBand);
+    forecastChart->addSeries(forecastMedian);
+
+    forecastAxisX = new QDateTimeAxis();
+    forecastAxisX->setFormat("MMM yy");
+    forecastAxisX->setLabelsBrush(QBrush(QColor("#bbb")));
+    forecastAxisY = new QValueAxis();
+    forecastAxisY->setLabelFormat("%.0f");
+    forecastAxisY->setLabelsBrush(QBrush(QColor("#bbb")));
+    forecastChart->addAxis(forecastAxisX, Qt::AlignBottom);
+    forecastChart->addAxis(forecastAxisY, Qt::AlignLeft);
+    for (QAbstractSeries *series : forecastChart->series()) {
+        series->attachAxis(forecastAxisX);
+        series->attachAxis(forecastAxisY);
+    }
+
+    QChartView *forecastView = new QChartView(forecastChart);
+    forecastView->setRenderHint(QPainter::Antialiasing);
+    forecastLayout->addLayout(forecastControls);
+    forecastLayout->addWidget(forecastView);
+    forecastGroup->setLayout(forecastLayout);
+    forecastGroup->setFixedHeight(280);
+
+    QHBoxLayout *chartsLayout = new QHBoxLayout();
+    chartsLayout->addWidget(chartView, 1);
+    chartsLayout->addWidget(forecastGroup, 1);
+    mainLayout->addLayout(chartsLayout);
 
     // Table
-    transactionTable = new QTableWidget();
-    transactionTable->setColumnCount(6);
-    transactionTable->setHorizontalHeaderLabels({"ID", "Date", "Type", "Category", "Amount", "Description"});
+    transactionModel = new TransactionModel(this);
+    transactionTable = new QTableView();
+    transactionTable->setModel(transactionModel);
     transactionTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     transactionTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    transactionTable->hideColumn(0);
+    transactionTable->hideColumn(TransactionModel::IdColumn);
     mainLayout->addWidget(transactionTable);
 
     // Actions
@@ -142,75 +254,203 @@ void FInanceTracker::setupUI()
     deleteBtn = new QPushButton("Delete Selected");
     deleteBtn->setStyleSheet("background-color: #d32f2f;");
     exportBtn = new QPushButton("Export CSV");
+    importBtn = new QPushButton("Import CSV");
+    auditBtn = new QPushButton("Find Duplicates && Outliers");
 
     actionLayout->addWidget(deleteBtn);
     actionLayout->addWidget(exportBtn);
+    actionLayout->addWidget(importBtn);
+    actionLayout->addWidget(auditBtn);
     actionLayout->addStretch();
     mainLayout->addLayout(actionLayout);
 
     connect(addBtn, &QPushButton::clicked, this, &FInanceTracker::addTransaction);
     connect(deleteBtn, &QPushButton::clicked, this, &FInanceTracker::deleteTransaction);
     connect(exportBtn, &QPushButton::clicked, this, &FInanceTracker::exportToCSV);
+    connect(importBtn, &QPushButton::clicked, this, &FInanceTracker::importFromCSV);
+    connect(auditBtn, &QPushButton::clicked, this, &FInanceTracker::auditLedger);
+    connect(horizonSpin, &QSpinBox::valueChanged, this, &FInanceTracker::updateProjection);
+    connect(incomeSlider, &QSlider::valueChanged, this, [this](int value) {
+        incomeSliderLabel->setText(QString("Income %1%2%").arg(value >= 0 ? "+" : "").arg(value));
+        updateProjection();
+    });
+    connect(expenseSlider, &QSlider::valueChanged, this, [this](int value) {
+        expenseSliderLabel->setText(QString("Expenses %1%2%").arg(value >= 0 ? "+" : "").arg(value));
+        updateProjection();
+    });
 
     setCentralWidget(centralWidget);
 }
 
 void FInanceTracker::addTransaction() {
-    QString date = dateEdit->date().toString("yyyy-MM-dd");
-    QString type = typeCombo->currentText();
-    QString category = categoryCombo->currentText();
-    double amount = amountEdit->text().toDouble();
-    QString desc = descriptionEdit->text();
-
-    if (amount <= 0) {
+    TransactionRecord record;
+    record.date = dateEdit->date().toString("yyyy-MM-dd");
+    record.type = typeCombo->currentText();
+    record.category = categoryCombo->currentText();
+    record.amount = amountEdit->text().toDouble();
+    record.description = descriptionEdit->text();
+
+    if (record.amount <= 0) {
         QMessageBox::warning(this, "Input Error", "Please enter a valid amount.");
         return;
     }
-
-    QSqlQuery query;
-    query.prepare("INSERT INTO transactions (date, type, category, amount, description) VALUES (?, ?, ?, ?, ?)");
-    query.addBindValue(date);
-    query.addBindValue(type);
-    query.addBindValue(category);
-    query.addBindValue(amount);
-    query.addBindValue(desc);
-
-    if (query.exec()) {
-        amountEdit->clear();
-        descriptionEdit->clear();
-        loadTransactions();
-        updateSummary();
-        updateChart();
+    if (!writeQueue) return;
+
+    const QList<AuditFinding> findings = auditor.check(transactionModel->store(), record);
+    QString outlierNote;
+    for (const AuditFinding &finding : findings) {
+        if (finding.kind == AuditFinding::Outlier) {
+            outlierNote = QString("%1 is %2x the recent median for %3.")
+                              .arg(formatRupiah(record.amount)).arg(finding.score, 0, 'f', 1).arg(record.category);
+        }
     }
+    // Ask about the first duplicate only.
+    for (const AuditFinding &finding : findings) {
+        if (finding.kind == AuditFinding::Outlier) continue;
+        const int other = transactionModel->store().rowForId(finding.otherId);
+        if (other < 0) continue;
+        const QString question = QString("This looks like a %1 of\n%2\n\nAdd it anyway?")
+                                     .arg(finding.kind == AuditFinding::ExactDuplicate ? "duplicate" : "near duplicate")
+                                     .arg(describeRow(other));
+        if (QMessageBox::question(this, "Possible Duplicate", question) != QMessageBox::Yes) return;
+        break;
+    }
+
+    // Show the row right away; the write queue commits it in the background
+    // and onWritesCommitted() swaps the pending id for the real one.
+    record.id = -writeQueue->enqueueInsert(record);
+    auditor.add(record);
+    if (!outlierNote.isEmpty()) statusBar()->showMessage("Unusual expense: " + outlierNote, 8000);
+
+    transactionModel->insertRecord(transactionModel->store().insertPosition(record.date), record);
+
+    if (record.type == "Income") totalIncome += record.amount;
+    else totalExpense += record.amount;
+    refreshSummaryLabels();
+
+    amountEdit->clear();
+    descriptionEdit->clear();
 }
 
 void FInanceTracker::deleteTransaction() {
-    int row = transactionTable->currentRow();
-    if (row < 0) return;
+    int row = transactionTable->currentIndex().row();
+    if (row < 0 || !writeQueue) return;
+
+    const TransactionStore &store = transactionModel->store();
+    qint64 id = store.id(row);
+    if (store.type(row) == "Income") totalIncome -= store.amount(row);
+    else totalExpense -= store.amount(row);
+
+    // Keep the row until the delete commits so a failed write can restore it.
+    const TransactionRecord record = store.record(row);
+    const qint64 ticket = writeQueue->enqueueDelete(id);
+    if (id > 0) pendingDeletes.insert(ticket, record);
+    auditor.remove(record);
+    transactionModel->removeRecord(row);
+    refreshSummaryLabels();
+}
 
-    int id = transactionTable->item(row, 0)->text().toInt();
-    QSqlQuery query;
-    query.prepare("DELETE FROM transactions WHERE id = ?");
-    query.addBindValue(id);
+void FInanceTracker::onWritesCommitted(const QList<WriteAck> &acks) {
+    QHash<qint64, qint64> inserted; // pending id -> database id
+    bool changed = false;
+    for (const WriteAck &ack : acks) {
+        // importFromCSV() reloaded the table itself once its rows committed.
+        if (ack.ticket >= importFirstTicket && ack.ticket < importEndTicket) continue;
+        changed = true;
+        pendingDeletes.remove(ack.ticket);
+        if (ack.rowId <= 0) continue;
+        inserted.insert(-ack.ticket, ack.rowId);
+    }
+    if (!changed) return;
+
+    const TransactionStore &store = transactionModel->store();
+    for (int row = 0; row < store.size() && !inserted.isEmpty(); ++row) {
+        qint64 id = store.id(row);
+        if (id < 0 && inserted.contains(id)) transactionModel->setRecordId(row, inserted.take(id));
+    }
+    if (apiServer) apiServer->invalidateCache();
+    // Totals were already adjusted optimistically; only the chart reads the database.
+    updateChart();
+    rebuildProjection();
+}
 
-    if (query.exec()) {
-        loadTransactions();
-        updateSummary();
-        updateChart();
+void FInanceTracker::onWritesFailed(const QString &error, const QList<qint64> &tickets) {
+    // Undo only the failed writes; rows whose inserts are still queued stay.
+    QSet<qint64> failedInserts;
+    for (qint64 ticket : tickets) {
+        auto deleted = pendingDeletes.constFind(ticket);
+        if (deleted == pendingDeletes.constEnd()) {
+            failedInserts.insert(-ticket);
+            continue;
+        }
+        const TransactionRecord record = deleted.value();
+        pendingDeletes.erase(deleted);
+        auditor.add(record);
+        transactionModel->insertRecord(transactionModel->store().insertPosition(record.date), record);
+        if (record.type == "Income") totalIncome += record.amount;
+        else totalExpense += record.amount;
+    }
+
+    const TransactionStore &store = transactionModel->store();
+    for (int row = store.size() - 1; row >= 0 && !failedInserts.isEmpty(); --row) {
+        const qint64 id = store.id(row);
+        if (id >= 0 || !failedInserts.remove(id)) continue;
+        auditor.remove(store.record(row));
+        if (store.type(row) == "Income") totalIncome -= store.amount(row);
+        else totalExpense -= store.amount(row);
+        transactionModel->removeRecord(row);
     }
+
+    refreshSummaryLabels();
+    updateChart();
+    rebuildProjection();
+    QMessageBox::warning(this, "Database Error", "Some changes could not be saved: " + error);
+}
+
+QString FInanceTracker::describeRow(int row) const {
+    const TransactionStore &store = transactionModel->store();
+    QString text = store.date(row).toString("yyyy-MM-dd") + "  " + store.category(row) + "  " + formatRupiah(store.amount(row));
+    const QString desc = store.description(row);
+    return desc.isEmpty() ? text : text + "  \"" + desc + "\"";
 }
 
 void FInanceTracker::loadTransactions() {
-    transactionTable->setRowCount(0);
-    QSqlQuery query("SELECT * FROM transactions ORDER BY date DESC");
+    // Rows go into the model in chunks so the full result set never exists
+    // as QStrings at once.
+    const int chunkSize = 4096;
+    QList<TransactionRecord> chunk;
+    chunk.reserve(chunkSize);
+
+    // Rows without a valid date could land anywhere in the ORDER BY; they
+    // are held back and appended last, where the store keeps them.
+    QList<TransactionRecord> undated;
+
+    transactionModel->clear();
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.exec("SELECT id, date, type, category, amount, description FROM transactions ORDER BY date DESC");
     while (query.next()) {
-        int row = transactionTable->rowCount();
-        transactionTable->insertRow(row);
-        for(int i=0; i<6; ++i) {
-            QString val = (i == 4) ? formatRupiah(query.value(i).toDouble()) : query.value(i).toString();
-            transactionTable->setItem(row, i, new QTableWidgetItem(val));
+        TransactionRecord record;
+        record.id = query.value(0).toLongLong();
+        record.date = query.value(1).toString();
+        record.type = query.value(2).toString();
+        record.category = query.value(3).toString();
+        record.amount = query.value(4).toDouble();
+        record.description = query.value(5).toString();
+        if (!QDate::fromString(record.date, Qt::ISODate).isValid()) {
+            undated.append(record);
+            continue;
+        }
+        chunk.append(record);
+        if (chunk.size() == chunkSize) {
+            transactionModel->appendRecords(chunk);
+            chunk.clear();
         }
     }
+    transactionModel->appendRecords(chunk);
+    transactionModel->appendRecords(undated);
+    auditor.rebuild(transactionModel->store());
+    rebuildProjection();
 }
 
 void FInanceTracker::updateSummary() {
@@ -221,12 +461,99 @@ void FInanceTracker::updateSummary() {
         else totalExpense = query.value(1).toDouble();
     }
 
+    refreshSummaryLabels();
+}
+
+void FInanceTracker::refreshSummaryLabels() {
     double balance = totalIncome - totalExpense;
     totalIncomeLabel->setText("Income: " + formatRupiah(totalIncome));
     totalExpenseLabel->setText("Expenses: " + formatRupiah(totalExpense));
     balanceLabel->setText("Balance: " + formatRupiah(balance));
     balanceLabel->setStyleSheet(QString("background-color: %1; font-weight: bold; font-size: 15pt; border-radius: 6px; padding: 8px;")
                                     .arg(balance >= 0 ? "#2e7d32" : "#c62828"));
+    updateProjection();
+}
+
+void FInanceTracker::rebuildProjection() {
+    // Aggregate history on a worker from an implicitly shared snapshot of the
+    // store; further requests while one runs collapse into a single rerun.
+    if (projectionRebuilding) {
+        projectionRebuildPending = true;
+        return;
+    }
+    projectionRebuilding = true;
+
+    using EnginePtr = std::shared_ptr<const ProjectionEngine>;
+    auto *watcher = new QFutureWatcher<EnginePtr>(this);
+    connect(watcher, &QFutureWatcher<EnginePtr>::finished, this, [this, watcher] {
+        projectionEngine = watcher->result();
+        watcher->deleteLater();
+        projectionRebuilding = false;
+        if (projectionRebuildPending) {
+            projectionRebuildPending = false;
+            rebuildProjection();
+        }
+        updateProjection();
+    });
+    watcher->setFuture(QtConcurrent::run([store = transactionModel->store(), today = QDate::currentDate()] {
+        auto engine = std::make_shared<ProjectionEngine>();
+        engine->build(store, today);
+        return EnginePtr(engine);
+    }));
+}
+
+void FInanceTracker::updateProjection() {
+    if (!projectionEngine) return;
+    if (projecting) {
+        projectionPending = true;
+        return;
+    }
+    projecting = true;
+
+    ProjectionEngine::Assumptions assumptions;
+    assumptions.months = horizonSpin->value();
+    assumptions.startBalance = totalIncome - totalExpense;
+    assumptions.incomeChange = incomeSlider->value() / 100.0;
+    assumptions.expenseChange = expenseSlider->value() / 100.0;
+
+    auto *watcher = new QFutureWatcher<ProjectionEngine::Projection>(this);
+    connect(watcher, &QFutureWatcher<ProjectionEngine::Projection>::finished, this, [this, watcher] {
+        showProjection(watcher->result());
+        watcher->deleteLater();
+        projecting = false;
+        if (projectionPending) {
+            projectionPending = false;
+            updateProjection();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([engine = projectionEngine, assumptions] { return engine->project(assumptions); }));
+}
+
+void FInanceTracker::showProjection(const ProjectionEngine::Projection &projection) {
+    if (projection.median.isEmpty()) return;
+
+    auto x = [](const QDate &date) { return qreal(QDateTime(date, QTime(0, 0)).toMSecsSinceEpoch()); };
+    const qreal start = x(QDate::currentDate());
+    QList<QPointF> low{{start, projection.startBalance}};
+    QList<QPointF> high = low, median = low;
+    double minimum = projection.startBalance, maximum = projection.startBalance;
+
+    for (qsizetype h = 0; h < projection.median.size(); ++h) {
+        const qreal monthEnd = x(projection.firstMonth.addMonths(int(h) + 1).addDays(-1));
+        low.append({monthEnd, projection.low[h]});
+        high.append({monthEnd, projection.high[h]});
+        median.append({monthEnd, projection.median[h]});
+        minimum = qMin(minimum, projection.low[h]);
+        maximum = qMax(maximum, projection.high[h]);
+    }
+    forecastLow->replace(low);
+    forecastHigh->replace(high);
+    forecastMedian->replace(median);
+
+    const double padding = qMax(1.0, (maximum - minimum) * 0.05);
+    forecastAxisX->setRange(QDateTime::fromMSecsSinceEpoch(qint64(start)),
+                            QDateTime::fromMSecsSinceEpoch(qint64(median.last().x())));
+    forecastAxisY->setRange(minimum - padding, maximum + padding);
 }
 
 void FInanceTracker::updateChart() {
@@ -257,5 +584,167 @@ void FInanceTracker::exportToCSV() {
     }
 }
 
+void FInanceTracker::importFromCSV() {
+    QString filename = QFileDialog::getOpenFileName(this, "Import", "", "CSV Files (*.csv)");
+    if (filename.isEmpty() || !writeQueue) return;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, "Import Error", "Could not open " + filename);
+        return;
+    }
+
+    // Same layout as exportToCSV(): Date,Type,Category,Amount,Description
+    QList<TransactionRecord> records;
+    QList<qsizetype> uncategorized;
+    QStringList descriptions;
+    int skipped = 0;
+    QStringList duplicates;                // skipped: same date, amount and description text
+    QList<qsizetype> possibleDuplicates;   // same after normalizing the description; ask first
+    QMultiHash<QPair<QString, qint64>, qsizetype> imported; // (date, cents) -> index in records
+    const TransactionStore &store = transactionModel->store();
+    auto describe = [this](const TransactionRecord &record) {
+        const QString text = record.date + "  " + record.category + "  " + formatRupiah(record.amount);
+        return record.description.isEmpty() ? text : text + "  \"" + record.description + "\"";
+    };
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QStringList fields = splitCsvLine(in.readLine());
+        if (fields.size() < 4 || fields[0].trimmed() == "Date") continue;
+
+        TransactionRecord record;
+        record.date = fields[0].trimmed();
+        record.type = fields[1].trimmed().compare("Income", Qt::CaseInsensitive) == 0 ? "Income" : "Expense";
+        record.category = fields[2].trimmed();
+        record.amount = fields[3].trimmed().toDouble();
+        record.description = fields.size() > 4 ? fields.mid(4).join(',').trimmed() : QString();
+
+        if (!QDate::fromString(record.date, "yyyy-MM-dd").isValid() || record.amount <= 0) {
+            ++skipped;
+            continue;
+        }
+        // Overlapping statement exports repeat rows that are already in the
+        // ledger or earlier in the same file. Only an identical description
+        // is skipped outright; rows that merely normalize the same are asked
+        // about below.
+        const QList<int> ledgerTwins = auditor.exactDuplicateRows(store, record);
+        const QPair<QString, qint64> key(record.date, qRound64(record.amount * 100));
+        QList<qsizetype> fileTwins = imported.values(key);
+        fileTwins.removeIf([&](qsizetype i) { return !LedgerAuditor::sameTransaction(records[i], record); });
+        if (!ledgerTwins.isEmpty() || !fileTwins.isEmpty()) {
+            const bool identical =
+                std::any_of(ledgerTwins.begin(), ledgerTwins.end(),
+                            [&](int row) { return store.description(row).trimmed() == record.description; })
+                || std::any_of(fileTwins.begin(), fileTwins.end(),
+                               [&](qsizetype i) { return records[i].description == record.description; });
+            if (identical) {
+                duplicates << describe(record);
+                continue;
+            }
+            possibleDuplicates.append(records.size());
+        }
+        imported.insert(key, records.size());
+        records.append(record);
+    }
+
+    if (!possibleDuplicates.isEmpty()) {
+        QStringList lines;
+        for (qsizetype i : std::as_const(possibleDuplicates)) lines << describe(records[i]);
+        QApplication::restoreOverrideCursor();
+        QMessageBox box(QMessageBox::Question, "Import",
+                        QString("%1 rows match an existing transaction except for the exact description text. "
+                                "Import them anyway?").arg(possibleDuplicates.size()),
+                        QMessageBox::Yes | QMessageBox::No, this);
+        box.setDetailedText(lines.join('\n'));
+        const bool keep = box.exec() == QMessageBox::Yes;
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        if (!keep) {
+            for (qsizetype n = possibleDuplicates.size() - 1; n >= 0; --n) records.removeAt(possibleDuplicates[n]);
+            duplicates << lines;
+        }
+    }
+
+    for (qsizetype i = 0; i < records.size(); ++i) {
+        if (!records[i].category.isEmpty()) continue;
+        uncategorized.append(i);
+        descriptions.append(records[i].description);
+    }
+    if (!uncategorized.isEmpty()) {
+        Categorizer categorizer;
+        categorizer.loadDefaultRules();
+        categorizer.trainFromDatabase(db);
+        categorizer.build();
+        const QStringList categories = categorizer.categorizeBatch(descriptions);
+        for (qsizetype i = 0; i < uncategorized.size(); ++i)
+            records[uncategorized[i]].category = categories[i].isEmpty() ? "Other" : categories[i];
+    }
+
+    importFirstTicket = writeQueue->enqueueInsertBatch(records);
+    importEndTicket = importFirstTicket + records.size();
+    writeQueue->flush();
+    if (apiServer) apiServer->invalidateCache();
+    loadTransactions();
+    updateSummary();
+    updateChart();
+    QApplication::restoreOverrideCursor();
+
+    QMessageBox box(QMessageBox::Information, "Import",
+                    QString("Imported %1 transactions (%2 categorized automatically, "
+                            "%3 duplicates and %4 invalid rows skipped).")
+                        .arg(records.size()).arg(uncategorized.size()).arg(duplicates.size()).arg(skipped),
+                    QMessageBox::Ok, this);
+    if (!duplicates.isEmpty()) box.setDetailedText("Skipped duplicates:\n" + duplicates.join('\n'));
+    box.exec();
+}
+
+void FInanceTracker::auditLedger() {
+    // Scan copies of the store and the auditor so edits can continue meanwhile;
+    // both are implicitly shared, so this copies no rows up front.
+    auditBtn->setEnabled(false);
+    auto *watcher = new QFutureWatcher<QList<AuditFinding>>(this);
+    connect(watcher, &QFutureWatcher<QList<AuditFinding>>::finished, this, [this, watcher] {
+        const QList<AuditFinding> findings = watcher->result();
+        watcher->deleteLater();
+        auditBtn->setEnabled(true);
+
+        const TransactionStore &store = transactionModel->store();
+        QHash<qint64, int> rows;
+        rows.reserve(store.size());
+        for (int row = 0; row < store.size(); ++row) rows.insert(store.id(row), row);
+
+        const int maxListed = 200;
+        int duplicates = 0, outliers = 0;
+        QStringList lines;
+        for (const AuditFinding &finding : findings) {
+            const int row = rows.value(finding.id, -1);
+            if (row < 0) continue;
+            if (finding.kind == AuditFinding::Outlier) {
+                ++outliers;
+                if (lines.size() < maxListed)
+                    lines << QString("Outlier (%1x median): %2").arg(finding.score, 0, 'f', 1).arg(describeRow(row));
+                continue;
+            }
+            const int other = rows.value(finding.otherId, -1);
+            if (other < 0) continue;
+            ++duplicates;
+            if (lines.size() < maxListed)
+                lines << QString("%1: %2\n    matches %3")
+                             .arg(finding.kind == AuditFinding::ExactDuplicate ? "Duplicate" : "Near duplicate")
+                             .arg(describeRow(row), describeRow(other));
+        }
+
+        QMessageBox box(QMessageBox::Information, "Ledger Check",
+                        QString("Found %1 possible duplicates and %2 unusual expenses.").arg(duplicates).arg(outliers),
+                        QMessageBox::Ok, this);
+        if (!lines.isEmpty()) box.setDetailedText(lines.join('\n'));
+        box.exec();
+    });
+    watcher->setFuture(QtConcurrent::run([snapshot = auditor, store = transactionModel->store()] {
+        return snapshot.scan(store);
+    }));
+}
+
 void FInanceTracker::filterByCategory() { /* TODO: Implement filtering */ }
 void FInanceTracker::filterByDateRange() { /* TODO: Implement date range filter */ }
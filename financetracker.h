@@ -3,15 +3,28 @@
 
 #include <QMainWindow>
 #include <QSqlDatabase>
-#include <QTableWidget>
+#include <QTableView>
 #include <QPushButton>
 #include <QLineEdit>
 #include <QComboBox>
 #include <QDateEdit>
 #include <QLabel>
+#include <QSlider>
+#include <QSpinBox>
 #include <QtCharts/QChartView>
 #include <QtCharts/QChart>
 #include <QtCharts/QPieSeries>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QAreaSeries>
+#include <QtCharts/QDateTimeAxis>
+#include <QtCharts/QValueAxis>
+#include <memory>
+#include "writequeue.h"
+#include "ledgerauditor.h"
+#include "transactionmodel.h"
+#include "projectionengine.h"
+
+class ApiServer;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -27,6 +40,8 @@ public:
     FInanceTracker(QWidget *parent = nullptr);
     ~FInanceTracker();
 
+    bool startApiServer(quint16 port);
+
 private slots:
     void addTransaction();
     void deleteTransaction();
@@ -34,19 +49,40 @@ private slots:
     void filterByCategory();
     void filterByDateRange();
     void exportToCSV();
+    void importFromCSV();
+    void auditLedger();
     void updateChart();
+    void rebuildProjection();
+    void updateProjection();
+    void onWritesCommitted(const QList<WriteAck> &acks);
+    void onWritesFailed(const QString &error, const QList<qint64> &tickets);
 
 private:
     void setupDatabase();
     void setupUI();
     void loadTransactions();
     void calculateBalance();
+    void refreshSummaryLabels();
+    void showProjection(const ProjectionEngine::Projection &projection);
+    QString describeRow(int row) const;
 
     QSqlDatabase db;
+    WriteQueue *writeQueue;
+    ApiServer *apiServer;
+    LedgerAuditor auditor;
+    QHash<qint64, TransactionRecord> pendingDeletes; // write ticket -> deleted row
+    qint64 importFirstTicket;                        // [first, end) of the last import,
+    qint64 importEndTicket;                          // whose rows were reloaded already
+    std::shared_ptr<const ProjectionEngine> projectionEngine;
+    bool projectionRebuilding;
+    bool projectionRebuildPending;
+    bool projecting;
+    bool projectionPending;
     QString formatRupiah(double amount);
 
     // UI Components
-    QTableWidget *transactionTable;
+    QTableView *transactionTable;
+    TransactionModel *transactionModel;
     QLineEdit *amountEdit;
     QLineEdit *descriptionEdit;
     QComboBox *categoryCombo;
@@ -55,6 +91,8 @@ private:
     QPushButton *addBtn;
     QPushButton *deleteBtn;
     QPushButton *exportBtn;
+    QPushButton *importBtn;
+    QPushButton *auditBtn;
 
     QLabel *totalIncomeLabel;
     QLabel *totalExpenseLabel;
@@ -63,6 +101,18 @@ private:
     QChartView *chartView;
     QChart *pieChart;
 
+    QSpinBox *horizonSpin;
+    QSlider *incomeSlider;
+    QSlider *expenseSlider;
+    QLabel *incomeSliderLabel;
+    QLabel *expenseSliderLabel;
+    QChart *forecastChart;
+    QLineSeries *forecastLow;
+    QLineSeries *forecastHigh;
+    QLineSeries *forecastMedian;
+    QDateTimeAxis *forecastAxisX;
+    QValueAxis *forecastAxisY;
+
     double totalIncome;
     double totalExpense;
 };
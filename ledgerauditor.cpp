@@ -0,0 +1,230 @@
+#include "ledgerauditor.h"
+#include "transactionstore.h"
+#include "wordhash.h"
+#include <QDate>
+#include <algorithm>
+
+namespace {
+
+inline bool isIncome(const QString &type)
+{
+    return type == QLatin1String("Income");
+}
+
+} // namespace
+
+QList<quint64> LedgerAuditor::wordsOf(const QString &description)
+{
+    // Unlike the categorizer, keep numbers: "Transfer 123456" and
+    // "Transfer 654321" are two different payments.
+    QList<quint64> words;
+    WordHash::forEachToken(description, [&words](quint64 hash, int, bool) { words.append(hash); });
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+double LedgerAuditor::similarity(const QList<quint64> &a, const QList<quint64> &b)
+{
+    // Jaccard index of two sorted word sets. Two blank descriptions say
+    // nothing about whether the rows are the same purchase.
+    if (a.isEmpty() || b.isEmpty()) return 0;
+    qsizetype i = 0, j = 0, shared = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] == b[j]) { ++shared; ++i; ++j; }
+        else if (a[i] < b[j]) ++i;
+        else ++j;
+    }
+    return double(shared) / double(a.size() + b.size() - shared);
+}
+
+double LedgerAuditor::outlierRatio(qint64 cents, const QList<qint64> &sortedHistory) const
+{
+    const qsizetype n = sortedHistory.size();
+    if (n < minHistory) return 0;
+    const double median = (n % 2) ? sortedHistory[n / 2] : (sortedHistory[n / 2 - 1] + sortedHistory[n / 2]) / 2.0;
+    if (median <= 0) return 0;
+    const double ratio = cents / median;
+    return ratio > outlierFactor ? ratio : 0;
+}
+
+bool LedgerAuditor::sameTransaction(const TransactionRecord &a, const TransactionRecord &b)
+{
+    return a.date == b.date && qRound64(a.amount * 100) == qRound64(b.amount * 100)
+           && isIncome(a.type) == isIncome(b.type) && wordsOf(a.description) == wordsOf(b.description);
+}
+
+void LedgerAuditor::rebuild(const TransactionStore &store)
+{
+    // The store is newest first: collect the latest expenses per category
+    // until each window is full, then flip them to oldest first.
+    QList<QList<qint64>> recent;
+    for (int row = 0; row < store.size(); ++row) {
+        if (isIncome(store.type(row))) continue;
+        const int category = store.categoryId(row);
+        if (recent.size() <= category) recent.resize(category + 1);
+        if (recent[category].size() < medianWindow) recent[category].append(store.cents(row));
+    }
+
+    m_recentExpenses.clear();
+    for (int row = 0; row < store.size(); ++row) {
+        const int category = store.categoryId(row);
+        if (category >= recent.size() || recent[category].isEmpty()) continue;
+        std::reverse(recent[category].begin(), recent[category].end());
+        m_recentExpenses.insert(store.category(row), recent[category]);
+        recent[category].clear();
+    }
+}
+
+void LedgerAuditor::add(const TransactionRecord &record)
+{
+    if (isIncome(record.type)) return;
+    QList<qint64> &recent = m_recentExpenses[record.category];
+    recent.append(qRound64(record.amount * 100));
+    if (recent.size() > medianWindow) recent.removeFirst();
+}
+
+void LedgerAuditor::remove(const TransactionRecord &record)
+{
+    if (isIncome(record.type)) return;
+    auto it = m_recentExpenses.find(record.category);
+    if (it == m_recentExpenses.end()) return;
+    const qsizetype i = it->lastIndexOf(qRound64(record.amount * 100));
+    if (i >= 0) it->removeAt(i);
+}
+
+QList<int> LedgerAuditor::exactDuplicateRows(const TransactionStore &store, const TransactionRecord &record) const
+{
+    QList<int> rows;
+    const qint64 day = QDate::fromString(record.date, Qt::ISODate).toJulianDay();
+    const qint64 cents = qRound64(record.amount * 100);
+    const bool income = isIncome(record.type);
+    QList<quint64> words;
+    bool hashed = false;
+    for (int row = store.rowForDay(day); row < store.rowForDay(day - 1); ++row) {
+        if (store.cents(row) != cents || isIncome(store.type(row)) != income || store.id(row) == record.id) continue;
+        if (!hashed) {
+            words = wordsOf(record.description);
+            hashed = true;
+        }
+        if (wordsOf(store.description(row)) == words) rows.append(row);
+    }
+    return rows;
+}
+
+QList<AuditFinding> LedgerAuditor::check(const TransactionStore &store, const TransactionRecord &record) const
+{
+    QList<AuditFinding> findings;
+    const qint64 day = QDate::fromString(record.date, Qt::ISODate).toJulianDay();
+    const qint64 cents = qRound64(record.amount * 100);
+    const bool income = isIncome(record.type);
+
+    // Rows dated within the window are contiguous in the newest-first store.
+    const int first = store.rowForDay(day + dateWindow);
+    const int last = store.rowForDay(day - dateWindow - 1);
+    QList<quint64> words;
+    bool hashed = false;
+    for (int row = first; row < last; ++row) {
+        if (store.cents(row) != cents || isIncome(store.type(row)) != income || store.id(row) == record.id) continue;
+        if (!hashed) {
+            words = wordsOf(record.description);
+            hashed = true;
+        }
+        const QList<quint64> other = wordsOf(store.description(row));
+        if (store.julianDay(row) == day && other == words) {
+            findings.append({AuditFinding::ExactDuplicate, record.id, store.id(row), 1.0});
+            continue;
+        }
+        const double score = similarity(words, other);
+        if (score >= similarityThreshold) findings.append({AuditFinding::NearDuplicate, record.id, store.id(row), score});
+    }
+    // Report exact duplicates first.
+    std::stable_partition(findings.begin(), findings.end(),
+                          [](const AuditFinding &f) { return f.kind == AuditFinding::ExactDuplicate; });
+
+    if (!income) {
+        QList<qint64> history = m_recentExpenses.value(record.category);
+        std::sort(history.begin(), history.end());
+        const double ratio = outlierRatio(cents, history);
+        if (ratio > 0) findings.append({AuditFinding::Outlier, record.id, 0, ratio});
+    }
+    return findings;
+}
+
+QList<AuditFinding> LedgerAuditor::scan(const TransactionStore &store) const
+{
+    QList<AuditFinding> findings;
+
+    // Duplicates: block on (type, amount) and only compare rows whose dates
+    // fall inside the window, instead of every pair. The sort keys only live
+    // for the scan.
+    struct BlockKey
+    {
+        quint64 block;
+        qint64 day;
+        qint64 id;
+        int row;
+        bool operator<(const BlockKey &other) const
+        {
+            if (block != other.block) return block < other.block;
+            return day != other.day ? day < other.day : id < other.id;
+        }
+    };
+    QList<BlockKey> blocks;
+    blocks.reserve(store.size());
+    for (int row = 0; row < store.size(); ++row) {
+        if (store.julianDay(row) == TransactionStore::NoDay) continue; // undated rows have no window
+        blocks.append({blockKey(isIncome(store.type(row)), store.cents(row)), store.julianDay(row), store.id(row), row});
+    }
+    std::sort(blocks.begin(), blocks.end());
+
+    for (qsizetype i = 0; i < blocks.size(); ++i) {
+        const BlockKey &first = blocks[i];
+        QList<quint64> firstWords;
+        bool hashed = false;
+        for (qsizetype j = i + 1; j < blocks.size(); ++j) {
+            const BlockKey &second = blocks[j];
+            if (second.block != first.block || second.day - first.day > dateWindow) break;
+            if (!hashed) {
+                firstWords = wordsOf(store.description(first.row));
+                hashed = true;
+            }
+            const QList<quint64> secondWords = wordsOf(store.description(second.row));
+            if (second.day == first.day && secondWords == firstWords) {
+                findings.append({AuditFinding::ExactDuplicate, second.id, first.id, 1.0});
+                continue;
+            }
+            const double score = similarity(firstWords, secondWords);
+            if (score >= similarityThreshold) findings.append({AuditFinding::NearDuplicate, second.id, first.id, score});
+        }
+    }
+    blocks.clear();
+    blocks.squeeze();
+
+    // Outliers: walk each category in date order keeping the previous
+    // medianWindow expenses in a sorted window.
+    QList<BlockKey> expenses;
+    for (int row = 0; row < store.size(); ++row) {
+        if (!isIncome(store.type(row)))
+            expenses.append({quint64(store.categoryId(row)), store.julianDay(row), store.id(row), row});
+    }
+    std::sort(expenses.begin(), expenses.end());
+
+    QList<qint64> window;
+    window.reserve(medianWindow + 1);
+    for (qsizetype i = 0; i < expenses.size(); ++i) {
+        const BlockKey &entry = expenses[i];
+        if (i == 0 || expenses[i - 1].block != entry.block) window.clear();
+
+        const qint64 cents = store.cents(entry.row);
+        const double ratio = outlierRatio(cents, window);
+        if (ratio > 0) findings.append({AuditFinding::Outlier, entry.id, 0, ratio});
+
+        window.insert(std::lower_bound(window.begin(), window.end(), cents), cents);
+        if (window.size() > medianWindow) {
+            const qint64 expired = store.cents(expenses[i - medianWindow].row);
+            window.erase(std::lower_bound(window.begin(), window.end(), expired));
+        }
+    }
+    return findings;
+}
@@ -0,0 +1,65 @@
+#ifndef LEDGERAUDITOR_H
+#define LEDGERAUDITOR_H
+
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include "transactionrecord.h"
+
+class TransactionStore;
+
+struct AuditFinding
+{
+    enum Kind { ExactDuplicate, NearDuplicate, Outlier };
+
+    Kind kind;
+    qint64 id;
+    qint64 otherId; // the earlier record for duplicates, 0 for outliers
+    double score;   // description similarity, or amount / rolling median
+};
+
+// Finds duplicate and anomalous transactions in a TransactionStore. Exact
+// duplicates have the same date, type, amount and normalized description;
+// near duplicates have the same type and amount, dates within dateWindow
+// days and similar descriptions. Outliers are expenses more than
+// outlierFactor times the median of the previous medianWindow expenses in
+// their category.
+//
+// The store is the index: its rows are sorted by date, so the candidates
+// for one record are a single run of rows, and descriptions are hashed
+// into words only for rows whose type and amount already match. Apart from
+// the store, the auditor keeps just the recent expenses per category.
+// check() tests one record incrementally; scan() checks the whole store
+// using sorted-window blocking and can run on copies in another thread.
+class LedgerAuditor
+{
+public:
+    int dateWindow = 3;
+    double similarityThreshold = 0.6;
+    double outlierFactor = 3.0;
+    int medianWindow = 30;
+    int minHistory = 5;
+
+    void rebuild(const TransactionStore &store);
+    void add(const TransactionRecord &record);
+    // Takes a deleted or failed expense back out of its category's history.
+    void remove(const TransactionRecord &record);
+
+    QList<AuditFinding> check(const TransactionStore &store, const TransactionRecord &record) const;
+    QList<AuditFinding> scan(const TransactionStore &store) const;
+    // Rows that check() would report as exact duplicates of the record.
+    QList<int> exactDuplicateRows(const TransactionStore &store, const TransactionRecord &record) const;
+
+    // Whether check() would call one record an exact duplicate of the other.
+    static bool sameTransaction(const TransactionRecord &a, const TransactionRecord &b);
+
+private:
+    static QList<quint64> wordsOf(const QString &description); // sorted, unique
+    static quint64 blockKey(bool income, qint64 cents) { return (quint64(cents) << 1) | (income ? 1 : 0); }
+    static double similarity(const QList<quint64> &a, const QList<quint64> &b);
+    double outlierRatio(qint64 cents, const QList<qint64> &sortedHistory) const;
+
+    QHash<QString, QList<qint64>> m_recentExpenses; // per category, oldest first
+};
+
+#endif // LEDGERAUDITOR_H
@@ -1,11 +1,30 @@
 #include "financetracker.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QMessageBox>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption apiPortOption("api-port", "Serve a read-only JSON API on localhost:<port>.", "port");
+    parser.addOption(apiPortOption);
+    parser.process(a);
+
     FInanceTracker w;
+    if (parser.isSet(apiPortOption)) {
+        bool ok = false;
+        quint16 port = parser.value(apiPortOption).toUShort(&ok);
+        if (!ok || port == 0)
+            QMessageBox::warning(&w, "API Server",
+                                 QString("Invalid API port \"%1\"; expected a number from 1 to 65535.")
+                                     .arg(parser.value(apiPortOption)));
+        else if (!w.startApiServer(port))
+            QMessageBox::warning(&w, "API Server", QString("Could not listen on 127.0.0.1:%1").arg(port));
+    }
     w.show();
     return a.exec();
 }
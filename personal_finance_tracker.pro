@@ -1,4 +1,4 @@
-QT       += core gui sql charts
+QT       += core gui sql charts network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -10,10 +10,26 @@ CONFIG += c++17
 
 SOURCES += \
     main.cpp \
-    financetracker.cpp
+    apiserver.cpp \
+    categorizer.cpp \
+    financetracker.cpp \
+    ledgerauditor.cpp \
+    projectionengine.cpp \
+    transactionmodel.cpp \
+    transactionstore.cpp \
+    writequeue.cpp
 
 HEADERS += \
-    financetracker.h
+    apiserver.h \
+    categorizer.h \
+    financetracker.h \
+    ledgerauditor.h \
+    projectionengine.h \
+    transactionmodel.h \
+    transactionrecord.h \
+    transactionstore.h \
+    wordhash.h \
+    writequeue.h
 
 FORMS += \
     financetracker.ui
@@ -0,0 +1,234 @@
+#include "projectionengine.h"
+#include "transactionstore.h"
+#include "wordhash.h"
+#include <QHash>
+#include <QRandomGenerator>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int HistoryMonths = 24;
+const int RecurringMonths = 3;       // must appear in each of the last N full months
+const double RecurringTolerance = 0.15;
+const quint32 ShockSeed = 0x5eed;    // fixed so the band does not jitter between runs
+const double TwoPi = 6.283185307179586;
+const int Steps = ProjectionEngine::MaxMonths + 1; // the rest of this month, then full months
+
+inline int monthIndex(const QDate &date)
+{
+    return date.year() * 12 + date.month() - 1;
+}
+
+quint64 descriptionKey(int series, const QString &description)
+{
+    quint64 key = 0;
+    int words = 0;
+    WordHash::forEachWord(description, [&](quint64 hash) {
+        key = (key ^ hash) * 1099511628211ULL;
+        ++words;
+    });
+    if (words == 0) return 0;
+    return key ^ (quint64(series) << 48);
+}
+
+} // namespace
+
+void ProjectionEngine::build(const TransactionStore &store, const QDate &today)
+{
+    const int current = monthIndex(today);
+    const int lastFull = current - 1;
+    int windowStart = lastFull - HistoryMonths + 1;
+    const int oldest = store.rowForDay(TransactionStore::NoDay) - 1; // undated rows come last
+    if (oldest >= 0) windowStart = qMax(windowStart, monthIndex(store.date(oldest)));
+    const int window = qMax(0, lastFull - windowStart + 1);
+
+    // Step 0 is what is left of the current month: today's balance already
+    // holds the days gone by, so only the remaining share of it is projected.
+    m_firstMonth = QDate(today.year(), today.month(), 1);
+    m_firstFraction = double(today.daysInMonth() - today.day()) / today.daysInMonth();
+    m_categories.clear();
+    m_income.clear();
+
+    QHash<QPair<bool, QString>, int> seriesIds;
+    auto seriesOf = [&](int row) {
+        const QPair<bool, QString> key(store.type(row) == "Income", store.category(row));
+        auto it = seriesIds.constFind(key);
+        if (it != seriesIds.constEnd()) return it.value();
+        const int id = m_categories.size();
+        seriesIds.insert(key, id);
+        m_categories.append(key.second);
+        m_income.append(key.first);
+        return id;
+    };
+
+    // Pass 1: the last few full months, looking for steady repeating items.
+    struct Candidate
+    {
+        int series = 0;
+        double months[RecurringMonths] = {};
+    };
+    QHash<quint64, Candidate> candidates;
+    const int recurringStart = qMax(windowStart, lastFull - RecurringMonths + 1);
+    for (int row = 0; row < store.size(); ++row) {
+        const int month = monthIndex(store.date(row));
+        if (month > lastFull) continue;
+        if (month < recurringStart) break;
+        const int series = seriesOf(row);
+        const quint64 key = descriptionKey(series, store.description(row));
+        if (!key) continue;
+        Candidate &candidate = candidates[key];
+        candidate.series = series;
+        candidate.months[month - (lastFull - RecurringMonths + 1)] += store.amount(row);
+    }
+
+    QHash<quint64, double> recurring; // key -> monthly amount
+    if (lastFull - recurringStart + 1 == RecurringMonths) {
+        for (auto it = candidates.constBegin(); it != candidates.constEnd(); ++it) {
+            double sorted[RecurringMonths];
+            std::copy(it->months, it->months + RecurringMonths, sorted);
+            std::sort(sorted, sorted + RecurringMonths);
+            const double median = sorted[RecurringMonths / 2];
+            if (sorted[0] <= 0 || sorted[RecurringMonths - 1] - sorted[0] > RecurringTolerance * median) continue;
+            recurring.insert(it.key(), median);
+        }
+    }
+
+    // Recurring items that already posted this month are in today's balance.
+    QSet<quint64> posted;
+    for (int row = 0; row < store.size() && !recurring.isEmpty(); ++row) {
+        const int month = monthIndex(store.date(row));
+        if (month > current) continue;
+        if (month < current) break;
+        const quint64 key = descriptionKey(seriesOf(row), store.description(row));
+        if (recurring.contains(key)) posted.insert(key);
+    }
+
+    // Pass 2: monthly totals per series over the window, minus recurring items.
+    QList<QList<double>> totals;
+    for (int row = 0; row < store.size() && window > 0; ++row) {
+        const int month = monthIndex(store.date(row));
+        if (month > lastFull) continue;
+        if (month < windowStart) break;
+        const int series = seriesOf(row);
+        if (!recurring.isEmpty() && month >= recurringStart
+            && recurring.contains(descriptionKey(series, store.description(row))))
+            continue;
+        if (totals.size() <= series) totals.resize(series + 1);
+        if (totals[series].isEmpty()) totals[series].fill(0, window);
+        totals[series][month - windowStart] += store.amount(row);
+    }
+
+    // Recurring items were left out of the last months above. Older months
+    // are assumed to hold them too, so take their monthly amount out there
+    // as well rather than counting them twice.
+    const int seriesCount = m_categories.size();
+    m_recurring.fill(0, seriesCount);
+    m_recurringDue.fill(0, seriesCount);
+    for (auto it = recurring.constBegin(); it != recurring.constEnd(); ++it) {
+        const int series = candidates.value(it.key()).series;
+        m_recurring[series] += it.value();
+        if (!posted.contains(it.key())) m_recurringDue[series] += it.value();
+        if (series >= totals.size() || totals[series].isEmpty()) continue;
+        for (int m = 0; m < window - RecurringMonths; ++m)
+            totals[series][m] = qMax(0.0, totals[series][m] - it.value());
+    }
+
+    // Seasonal mean: with a full year of history, blend the same calendar
+    // month with the overall mean; otherwise use the overall mean.
+    m_mean.fill(0, qsizetype(seriesCount) * Steps);
+    m_variance.fill(0, seriesCount);
+    for (int series = 0; series < seriesCount && window > 0; ++series) {
+        if (series >= totals.size() || totals[series].isEmpty()) continue;
+        const QList<double> &values = totals[series];
+
+        double sum = 0;
+        for (double value : values) sum += value;
+        const double mean = sum / window;
+        double squares = 0;
+        for (double value : values) squares += (value - mean) * (value - mean);
+        m_variance[series] = squares / window;
+
+        for (int h = 0; h < Steps; ++h) {
+            double seasonal = mean;
+            if (window >= 12) {
+                const int calendar = (monthIndex(m_firstMonth) + h) % 12;
+                double same = 0;
+                int count = 0;
+                for (int m = 0; m < window; ++m) {
+                    if ((windowStart + m) % 12 == calendar) { same += values[m]; ++count; }
+                }
+                if (count > 0) seasonal = 0.5 * mean + 0.5 * same / count;
+            }
+            m_mean[qsizetype(series) * Steps + h] = seasonal;
+        }
+    }
+
+    // Standard normal shocks, month-major so each month's update is one
+    // contiguous loop over the paths.
+    QRandomGenerator random(ShockSeed);
+    m_shocks.resize(qsizetype(Steps) * Paths);
+    for (qsizetype i = 0; i < m_shocks.size(); i += 2) {
+        const double u1 = 1.0 - random.generateDouble();
+        const double u2 = random.generateDouble();
+        const double radius = std::sqrt(-2.0 * std::log(u1));
+        m_shocks[i] = radius * std::cos(TwoPi * u2);
+        if (i + 1 < m_shocks.size()) m_shocks[i + 1] = radius * std::sin(TwoPi * u2);
+    }
+}
+
+ProjectionEngine::Projection ProjectionEngine::project(const Assumptions &assumptions) const
+{
+    const int steps = qBound(1, assumptions.months, MaxMonths) + 1;
+    Projection result;
+    result.firstMonth = m_firstMonth;
+    result.startBalance = assumptions.startBalance;
+
+    // Collapse every series into one expected net flow and one standard
+    // deviation per month, treating categories as independent.
+    QList<double> net(steps, 0.0), sigma(steps, 0.0);
+    for (int series = 0; series < m_categories.size(); ++series) {
+        const double change = m_income[series] ? assumptions.incomeChange : assumptions.expenseChange;
+        const double scale = qMax(0.0, 1.0 + change);
+        const double sign = m_income[series] ? 1.0 : -1.0;
+        const double *mean = m_mean.constData() + qsizetype(series) * Steps;
+        const double variance = scale * scale * m_variance[series];
+        const double fixed = m_recurring[series];
+        // Step 0 pro-rates the irregular flow over the days left, but takes
+        // recurring items whole, and only those not yet posted this month.
+        net[0] += sign * scale * (m_firstFraction * mean[0] + m_recurringDue[series]);
+        sigma[0] += m_firstFraction * variance;
+        for (int h = 1; h < steps; ++h) {
+            net[h] += sign * scale * (mean[h] + fixed);
+            sigma[h] += variance;
+        }
+    }
+    for (int h = 0; h < steps; ++h) sigma[h] = std::sqrt(sigma[h]);
+
+    if (m_shocks.size() < qsizetype(Steps) * Paths) return result;
+
+    QList<double> balances(Paths, assumptions.startBalance);
+    QList<double> sorted(Paths);
+    double expected = assumptions.startBalance;
+    double *balance = balances.data();
+    for (int h = 0; h < steps; ++h) {
+        const double mu = net[h], sd = sigma[h];
+        const double *shock = m_shocks.constData() + qsizetype(h) * Paths;
+        for (int p = 0; p < Paths; ++p) balance[p] += mu + sd * shock[p];
+
+        expected += mu;
+        result.expected.append(expected);
+
+        std::copy(balances.constBegin(), balances.constEnd(), sorted.begin());
+        auto at = [&sorted](double fraction) {
+            auto nth = sorted.begin() + qsizetype(fraction * (Paths - 1));
+            std::nth_element(sorted.begin(), nth, sorted.end());
+            return *nth;
+        };
+        result.low.append(at(0.1));
+        result.median.append(at(0.5));
+        result.high.append(at(0.9));
+    }
+    return result;
+}
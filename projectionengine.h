@@ -0,0 +1,57 @@
+#ifndef PROJECTIONENGINE_H
+#define PROJECTIONENGINE_H
+
+#include <QDate>
+#include <QList>
+#include <QStringList>
+
+class TransactionStore;
+
+// Projects the balance to the end of the current month and up to MaxMonths
+// full months after it. build() folds the last two years of full months
+// into compact per-category arrays once: recurring items (same description
+// every month at a steady amount) become fixed monthly flows, and the rest
+// becomes a seasonal mean and a variance per category. The current month
+// takes its share of the seasonal mean plus whichever recurring items have
+// not posted yet. project() then only runs arithmetic over those arrays and a
+// fixed set of random shocks, cheap enough to call on every slider move.
+class ProjectionEngine
+{
+public:
+    static const int MaxMonths = 24;
+    static const int Paths = 2000;
+
+    struct Assumptions
+    {
+        int months = 12;                       // full months after the current one
+        double startBalance = 0;
+        double incomeChange = 0;               // fraction, e.g. 0.1 for +10%
+        double expenseChange = 0;
+    };
+
+    struct Projection
+    {
+        QDate firstMonth;       // the current month; balances are at the end of each month from here
+        double startBalance = 0;
+        QList<double> expected; // without random variation
+        QList<double> low;      // 10th percentile
+        QList<double> median;
+        QList<double> high;     // 90th percentile
+    };
+
+    void build(const TransactionStore &store, const QDate &today);
+    Projection project(const Assumptions &assumptions) const;
+
+private:
+    QDate m_firstMonth;
+    double m_firstFraction = 0;   // share of the current month still ahead
+    QStringList m_categories;     // per series
+    QList<bool> m_income;         // per series
+    QList<double> m_mean;         // series * (MaxMonths + 1), non-recurring seasonal mean
+    QList<double> m_variance;     // per series, of non-recurring monthly totals
+    QList<double> m_recurring;    // per series, fixed monthly amount
+    QList<double> m_recurringDue; // per series, recurring amount not yet posted this month
+    QList<double> m_shocks;       // (MaxMonths + 1) * Paths standard normals
+};
+
+#endif // PROJECTIONENGINE_H
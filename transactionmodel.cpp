@@ -0,0 +1,84 @@
+#include "transactionmodel.h"
+#include <QLocale>
+
+TransactionModel::TransactionModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+QString TransactionModel::formatRupiah(double amount)
+{
+    static const QLocale idr(QLocale::Indonesian, QLocale::Indonesia);
+    return idr.toCurrencyString(amount, "Rp");
+}
+
+void TransactionModel::clear()
+{
+    beginResetModel();
+    m_store.clear();
+    endResetModel();
+}
+
+void TransactionModel::appendRecords(const QList<TransactionRecord> &records)
+{
+    if (records.isEmpty()) return;
+    const int first = m_store.size();
+    beginInsertRows(QModelIndex(), first, first + records.size() - 1);
+    m_store.reserve(first + records.size());
+    for (const TransactionRecord &record : records) m_store.append(record);
+    endInsertRows();
+}
+
+void TransactionModel::insertRecord(int row, const TransactionRecord &record)
+{
+    beginInsertRows(QModelIndex(), row, row);
+    m_store.insert(row, record);
+    endInsertRows();
+}
+
+void TransactionModel::removeRecord(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+    m_store.remove(row);
+    endRemoveRows();
+}
+
+void TransactionModel::setRecordId(int row, qint64 id)
+{
+    m_store.setId(row, id);
+    const QModelIndex cell = index(row, IdColumn);
+    emit dataChanged(cell, cell, {Qt::DisplayRole});
+}
+
+int TransactionModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_store.size();
+}
+
+int TransactionModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TransactionModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+
+    const int row = index.row();
+    switch (index.column()) {
+    case IdColumn: return m_store.id(row);
+    case DateColumn: return m_store.date(row).toString("yyyy-MM-dd");
+    case TypeColumn: return m_store.type(row);
+    case CategoryColumn: return m_store.category(row);
+    case AmountColumn: return formatRupiah(m_store.amount(row));
+    case DescriptionColumn: return m_store.description(row);
+    }
+    return QVariant();
+}
+
+QVariant TransactionModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const QStringList headers = {"ID", "Date", "Type", "Category", "Amount", "Description"};
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) return QAbstractTableModel::headerData(section, orientation, role);
+    return headers.value(section);
+}
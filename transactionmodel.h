@@ -0,0 +1,37 @@
+#ifndef TRANSACTIONMODEL_H
+#define TRANSACTIONMODEL_H
+
+#include <QAbstractTableModel>
+#include "transactionstore.h"
+
+// Table model over a TransactionStore. Cell text is built in data(), so
+// only the rows the view actually paints ever become QStrings.
+class TransactionModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { IdColumn, DateColumn, TypeColumn, CategoryColumn, AmountColumn, DescriptionColumn, ColumnCount };
+
+    explicit TransactionModel(QObject *parent = nullptr);
+
+    const TransactionStore &store() const { return m_store; }
+
+    void clear();
+    void appendRecords(const QList<TransactionRecord> &records);
+    void insertRecord(int row, const TransactionRecord &record);
+    void removeRecord(int row);
+    void setRecordId(int row, qint64 id);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    static QString formatRupiah(double amount);
+
+private:
+    TransactionStore m_store;
+};
+
+#endif // TRANSACTIONMODEL_H
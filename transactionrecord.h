@@ -0,0 +1,19 @@
+#ifndef TRANSACTIONRECORD_H
+#define TRANSACTIONRECORD_H
+
+#include <QString>
+
+// One row of the transactions table as it travels between the UI and the
+// write queue. A negative id marks a record whose INSERT is still queued;
+// its absolute value is the write-queue ticket.
+struct TransactionRecord
+{
+    qint64 id = 0;
+    QString date; // yyyy-MM-dd
+    QString type;
+    QString category;
+    double amount = 0;
+    QString description;
+};
+
+#endif // TRANSACTIONRECORD_H
@@ -0,0 +1,126 @@
+#include "transactionstore.h"
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+template <typename Id>
+Id TransactionStore::intern(const QString &name, QStringList &names, QHash<QString, Id> &ids)
+{
+    auto it = ids.constFind(name);
+    if (it != ids.constEnd()) return it.value();
+
+    // Once every id but the last is taken, further names share one
+    // "Other" entry instead of wrapping onto an existing id.
+    QString interned = name;
+    if (names.size() >= qsizetype(std::numeric_limits<Id>::max())) {
+        interned = QStringLiteral("Other");
+        auto other = ids.constFind(interned);
+        if (other != ids.constEnd()) return other.value();
+    }
+    const Id id = Id(names.size());
+    names.append(interned);
+    ids.insert(interned, id);
+    return id;
+}
+
+void TransactionStore::clear()
+{
+    m_rows.clear();
+    m_arena.clear();
+    m_types.clear();
+    m_categories.clear();
+    m_typeIds.clear();
+    m_categoryIds.clear();
+}
+
+void TransactionStore::insert(int row, const TransactionRecord &record)
+{
+    // Amounts past 47 bits of cents and days past 24 bits are clamped
+    // rather than spilling into the packed ids. A missing or malformed date
+    // becomes NoDay, which sorts after every real one.
+    const qint64 maxCents = (qint64(1) << (63 - CategoryBits)) - 1;
+    const qint64 cents = qBound(-maxCents, qRound64(record.amount * 100), maxCents);
+    const QDate date = QDate::fromString(record.date, Qt::ISODate);
+    const qint64 day = date.isValid() ? qBound(NoDay + 1, date.toJulianDay(), qint64(0xffffff)) : NoDay;
+    const quint16 category = intern(record.category, m_categories, m_categoryIds);
+    const quint8 type = intern(record.type, m_types, m_typeIds);
+
+    PackedRow packed;
+    packed.id = record.id;
+    packed.amount = qint64(quint64(cents) << CategoryBits) | category;
+    packed.dayType = quint32(day) << TypeBits | type;
+    packed.descOffset = 0;
+
+    if (m_arena.isEmpty()) m_arena.append('\0');
+    if (!record.description.isEmpty()) {
+        const QByteArray utf8 = record.description.toUtf8();
+        packed.descOffset = quint32(m_arena.size());
+        if (utf8.size() < LongDescription) {
+            m_arena.append(char(utf8.size()));
+        } else {
+            m_arena.append(char(LongDescription));
+            const quint32 length = qToLittleEndian(quint32(utf8.size()));
+            m_arena.append(reinterpret_cast<const char *>(&length), sizeof(length));
+        }
+        m_arena.append(utf8);
+    }
+    m_rows.insert(row, packed);
+}
+
+int TransactionStore::insertPosition(const QString &date) const
+{
+    const QDate day = QDate::fromString(date, Qt::ISODate);
+    return rowForDay(day.isValid() ? day.toJulianDay() : NoDay);
+}
+
+int TransactionStore::rowForDay(qint64 julianDay) const
+{
+    int low = 0, high = size();
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        if (this->julianDay(mid) > julianDay) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+int TransactionStore::rowForId(qint64 id) const
+{
+    for (int row = 0; row < size(); ++row) {
+        if (m_rows[row].id == id) return row;
+    }
+    return -1;
+}
+
+QString TransactionStore::description(int row) const
+{
+    const char *text = m_arena.constData() + m_rows[row].descOffset;
+    qsizetype length = quint8(*text++);
+    if (length == LongDescription) {
+        quint32 prefix;
+        std::memcpy(&prefix, text, sizeof(prefix));
+        length = qFromLittleEndian(prefix);
+        text += sizeof(prefix);
+    }
+    return QString::fromUtf8(text, length);
+}
+
+TransactionRecord TransactionStore::record(int row) const
+{
+    TransactionRecord record;
+    record.id = id(row);
+    record.date = date(row).toString(Qt::ISODate);
+    record.type = type(row);
+    record.category = category(row);
+    record.amount = amount(row);
+    record.description = description(row);
+    return record;
+}
+
+qsizetype TransactionStore::memoryUsage() const
+{
+    qsizetype bytes = m_rows.capacity() * qsizetype(sizeof(PackedRow)) + m_arena.capacity();
+    for (const QString &name : m_types) bytes += name.capacity() * qsizetype(sizeof(QChar));
+    for (const QString &name : m_categories) bytes += name.capacity() * qsizetype(sizeof(QChar));
+    return bytes;
+}
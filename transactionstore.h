@@ -0,0 +1,78 @@
+#ifndef TRANSACTIONSTORE_H
+#define TRANSACTIONSTORE_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include "transactionrecord.h"
+
+// Compact in-memory copy of the loaded transactions, newest first, with
+// rows whose date is missing or malformed (NoDay) after all others.
+// Each row is 24 bytes: the 64-bit id, the amount in cents packed with the
+// interned category id, the julian day packed with the interned type id,
+// and the offset of the description in one UTF-8 arena. Strings are only
+// materialized when asked for.
+class TransactionStore
+{
+public:
+    static const qint64 NoDay = 0; // julian day kept for rows without a valid date
+
+    int size() const { return m_rows.size(); }
+    void clear();
+    void reserve(int rows) { m_rows.reserve(rows); }
+
+    void insert(int row, const TransactionRecord &record);
+    void append(const TransactionRecord &record) { insert(size(), record); }
+    void remove(int row) { m_rows.remove(row); }
+
+    // Row at which a record dated `date` keeps the newest-first order.
+    int insertPosition(const QString &date) const;
+    // First row dated on or before the given julian day.
+    int rowForDay(qint64 julianDay) const;
+    int rowForId(qint64 id) const;
+
+    qint64 id(int row) const { return m_rows[row].id; }
+    void setId(int row, qint64 id) { m_rows[row].id = id; }
+    qint64 julianDay(int row) const { return m_rows[row].dayType >> TypeBits; }
+    QDate date(int row) const { return julianDay(row) == NoDay ? QDate() : QDate::fromJulianDay(julianDay(row)); }
+    const QString &type(int row) const { return m_types[m_rows[row].dayType & TypeMask]; }
+    int categoryId(int row) const { return int(m_rows[row].amount & CategoryMask); }
+    const QString &category(int row) const { return m_categories[categoryId(row)]; }
+    qint64 cents(int row) const { return m_rows[row].amount >> CategoryBits; }
+    double amount(int row) const { return cents(row) / 100.0; }
+    QString description(int row) const;
+    TransactionRecord record(int row) const;
+
+    // Bytes held by rows, the description arena and the interned names.
+    qsizetype memoryUsage() const;
+
+private:
+    struct PackedRow
+    {
+        qint64 id;          // rowid, or -ticket while the insert is queued
+        qint64 amount;      // cents << CategoryBits | category
+        quint32 dayType;    // julian day << TypeBits | type
+        quint32 descOffset; // length-prefixed text in m_arena; 0 is the empty string
+    };
+    static_assert(sizeof(PackedRow) == 24, "PackedRow must stay 24 bytes");
+
+    static const int CategoryBits = 16;
+    static const qint64 CategoryMask = (1 << CategoryBits) - 1;
+    static const int TypeBits = 8;
+    static const quint32 TypeMask = (1 << TypeBits) - 1;
+    static const quint8 LongDescription = 255; // length byte; a 32-bit length follows
+
+    template <typename Id>
+    static Id intern(const QString &name, QStringList &names, QHash<QString, Id> &ids);
+
+    QList<PackedRow> m_rows;
+    QByteArray m_arena;
+    QStringList m_types;
+    QStringList m_categories;
+    QHash<QString, quint8> m_typeIds;
+    QHash<QString, quint16> m_categoryIds;
+};
+
+#endif // TRANSACTIONSTORE_H
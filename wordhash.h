@@ -0,0 +1,63 @@
+#ifndef WORDHASH_H
+#define WORDHASH_H
+
+#include <QString>
+
+// Description normalization shared by the categorizer and the ledger
+// auditor: ASCII letters and digits are compared case-insensitively and
+// every other character separates words.
+namespace WordHash {
+
+const int Separator = 36;
+
+inline int symbolOf(QChar c)
+{
+    const char16_t u = c.unicode();
+    if (u >= 'a' && u <= 'z') return u - 'a';
+    if (u >= 'A' && u <= 'Z') return u - 'A';
+    if (u >= '0' && u <= '9') return 26 + (u - '0');
+    return Separator;
+}
+
+// Calls onToken(hash, length, hasLetter) with the FNV-1a hash of every
+// run of letters and digits.
+template <typename F>
+void forEachToken(const QString &text, F onToken)
+{
+    const quint64 offset = 14695981039346656037ULL;
+    const quint64 prime = 1099511628211ULL;
+    quint64 hash = offset;
+    int length = 0;
+    bool hasLetter = false;
+    auto finish = [&] {
+        if (length > 0) onToken(hash, length, hasLetter);
+        hash = offset;
+        length = 0;
+        hasLetter = false;
+    };
+    for (QChar c : text) {
+        const int symbol = symbolOf(c);
+        if (symbol == Separator) {
+            finish();
+            continue;
+        }
+        hash = (hash ^ quint64(symbol + 1)) * prime;
+        ++length;
+        hasLetter |= symbol < 26;
+    }
+    finish();
+}
+
+// Calls onWord(hash) for every word of at least two characters that is not
+// purely numeric. Reference numbers carry no signal for categorizing.
+template <typename F>
+void forEachWord(const QString &text, F onWord)
+{
+    forEachToken(text, [&onWord](quint64 hash, int length, bool hasLetter) {
+        if (length >= 2 && hasLetter) onWord(hash);
+    });
+}
+
+} // namespace WordHash
+
+#endif // WORDHASH_H
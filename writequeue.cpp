@@ -0,0 +1,341 @@
+#include "writequeue.h"
+#include <QThread>
+#include <QTimer>
+#include <QSqlQuery>
+#include <QSqlError>
+
+namespace {
+const int DefaultFlushInterval = 50; // ms
+const int DefaultMaxBatchRows = 500;
+const int MinRetryDelay = 100;       // ms, doubled on every busy retry
+const int MaxRetryDelay = 5000;
+const int FlushAttempts = 4;
+}
+
+WriteQueue::WriteQueue(const QString &databaseName, QObject *parent)
+    : QObject(parent),
+      m_databaseName(databaseName),
+      m_connectionName(QStringLiteral("finance_writer")),
+      m_thread(new QThread),
+      m_context(new QObject),
+      m_timer(new QTimer(m_context)),
+      m_flushInterval(DefaultFlushInterval),
+      m_maxBatchRows(DefaultMaxBatchRows),
+      m_nextTicket(1),
+      m_timerArmed(false),
+      m_commitPosted(false),
+      m_retrying(false),
+      m_retryDelay(0)
+{
+    qRegisterMetaType<WriteAck>();
+    qRegisterMetaType<QList<WriteAck>>();
+
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, m_context, [this] { commitPending(); });
+
+    m_context->moveToThread(m_thread);
+    m_thread->setObjectName(QStringLiteral("WriteQueue"));
+    m_thread->start();
+    QMetaObject::invokeMethod(m_context, [this] { openConnection(); }, Qt::BlockingQueuedConnection);
+}
+
+WriteQueue::~WriteQueue()
+{
+    flush();
+    QMetaObject::invokeMethod(m_context, [this] { closeConnection(); }, Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+    delete m_context;
+    delete m_thread;
+}
+
+void WriteQueue::setFlushInterval(int msec)
+{
+    QMutexLocker lock(&m_mutex);
+    m_flushInterval = qMax(0, msec);
+}
+
+void WriteQueue::setMaxBatchRows(int rows)
+{
+    QMutexLocker lock(&m_mutex);
+    m_maxBatchRows = qMax(1, rows);
+}
+
+qint64 WriteQueue::enqueueInsert(const TransactionRecord &record)
+{
+    QMutexLocker lock(&m_mutex);
+    WriteOp op{OpKind::Insert, m_nextTicket++, record};
+    op.record.id = -op.ticket;
+    m_pending.append(op);
+    scheduleCommitLocked();
+    return op.ticket;
+}
+
+qint64 WriteQueue::enqueueInsertBatch(const QList<TransactionRecord> &records)
+{
+    QMutexLocker lock(&m_mutex);
+    const qint64 first = m_nextTicket;
+    m_pending.reserve(m_pending.size() + records.size());
+    for (const TransactionRecord &record : records) {
+        WriteOp op{OpKind::Insert, m_nextTicket++, record};
+        op.record.id = -op.ticket;
+        m_pending.append(op);
+    }
+    // commitPending() takes the whole queue, so the batch size cap does not
+    // split this into several transactions.
+    if (!records.isEmpty() && !m_retrying && !m_commitPosted) {
+        m_commitPosted = true;
+        QMetaObject::invokeMethod(m_context, [this] { commitPending(); }, Qt::QueuedConnection);
+    }
+    return first;
+}
+
+qint64 WriteQueue::enqueueUpdate(const TransactionRecord &record)
+{
+    QMutexLocker lock(&m_mutex);
+    const qint64 id = resolveLocked(record.id);
+
+    // Fold into a queued insert or update of the same row if there is one.
+    for (qsizetype i = m_pending.size() - 1; i >= 0; --i) {
+        WriteOp &op = m_pending[i];
+        if (op.record.id != id) continue;
+        if (op.kind == OpKind::Delete) break;
+        op.record = record;
+        op.record.id = id;
+        return op.ticket;
+    }
+
+    WriteOp op{OpKind::Update, m_nextTicket++, record};
+    op.record.id = id;
+    m_pending.append(op);
+    scheduleCommitLocked();
+    return op.ticket;
+}
+
+qint64 WriteQueue::enqueueDelete(qint64 id)
+{
+    QMutexLocker lock(&m_mutex);
+    id = resolveLocked(id);
+
+    for (qsizetype i = m_pending.size() - 1; i >= 0; --i) {
+        WriteOp &op = m_pending[i];
+        if (op.record.id != id) continue;
+        if (op.kind == OpKind::Delete) return op.ticket;
+        if (op.kind == OpKind::Update) {
+            op.kind = OpKind::Delete;
+            return op.ticket;
+        }
+        // The row never reached the database: drop the insert altogether.
+        qint64 ticket = op.ticket;
+        m_pending.removeAt(i);
+        m_coalesced.append({ticket, 0});
+        scheduleCommitLocked();
+        return ticket;
+    }
+
+    WriteOp op{OpKind::Delete, m_nextTicket++, TransactionRecord()};
+    op.record.id = id;
+    m_pending.append(op);
+    scheduleCommitLocked();
+    return op.ticket;
+}
+
+void WriteQueue::flush()
+{
+    auto drain = [this] {
+        for (int attempt = 1; !commitPending(attempt == FlushAttempts); ++attempt)
+            QThread::msleep(m_retryDelay);
+    };
+    if (QThread::currentThread() == m_thread) drain();
+    else QMetaObject::invokeMethod(m_context, drain, Qt::BlockingQueuedConnection);
+}
+
+void WriteQueue::scheduleCommitLocked()
+{
+    if (m_retrying) return; // the retry picks these up too
+    if (m_pending.size() >= m_maxBatchRows) {
+        if (!m_commitPosted) {
+            m_commitPosted = true;
+            QMetaObject::invokeMethod(m_context, [this] { commitPending(); }, Qt::QueuedConnection);
+        }
+    } else if (!m_timerArmed) {
+        m_timerArmed = true;
+        int interval = m_flushInterval;
+        QMetaObject::invokeMethod(m_context, [this, interval] { m_timer->start(interval); }, Qt::QueuedConnection);
+    }
+}
+
+void WriteQueue::openConnection()
+{
+    m_db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    m_db.setDatabaseName(m_databaseName);
+    m_db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    if (m_db.open()) {
+        QSqlQuery pragma(m_db);
+        pragma.exec("PRAGMA journal_mode=WAL");
+    }
+}
+
+void WriteQueue::closeConnection()
+{
+    m_db.close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+qint64 WriteQueue::resolveLocked(qint64 id) const
+{
+    return id < 0 ? m_resolved.value(-id, id) : id;
+}
+
+// Runs one transaction over the batch. Returns -1 once it is committed,
+// otherwise the index of the write that failed, or batch.size() if the
+// failure was not caused by any single write. Nothing is kept on failure.
+qsizetype WriteQueue::execBatch(const QList<WriteOp> &batch, QList<WriteAck> &acks,
+                                QHash<qint64, qint64> &resolved, QSqlError &error)
+{
+    if ((!m_db.isOpen() && !m_db.open()) || !m_db.transaction()) {
+        error = m_db.lastError();
+        return batch.size();
+    }
+
+    QSqlQuery insert(m_db), update(m_db), remove(m_db);
+    insert.prepare("INSERT INTO transactions (date, type, category, amount, description) VALUES (?, ?, ?, ?, ?)");
+    update.prepare("UPDATE transactions SET date = ?, type = ?, category = ?, amount = ?, description = ? WHERE id = ?");
+    remove.prepare("DELETE FROM transactions WHERE id = ?");
+
+    // Ids from earlier batches were patched into the queue when they
+    // committed, so only inserts from this batch are left to resolve.
+    auto resolveId = [&resolved](qint64 id) { return id < 0 ? resolved.value(-id, 0) : id; };
+
+    for (qsizetype i = 0; i < batch.size(); ++i) {
+        const WriteOp &op = batch.at(i);
+        QSqlQuery *query = nullptr;
+        qint64 rowId = 0;
+
+        if (op.kind == OpKind::Delete) {
+            query = &remove;
+            rowId = resolveId(op.record.id);
+        } else {
+            query = (op.kind == OpKind::Insert) ? &insert : &update;
+            query->addBindValue(op.record.date);
+            query->addBindValue(op.record.type);
+            query->addBindValue(op.record.category);
+            query->addBindValue(op.record.amount);
+            query->addBindValue(op.record.description);
+            if (op.kind == OpKind::Update) rowId = resolveId(op.record.id);
+        }
+        if (op.kind != OpKind::Insert) query->addBindValue(rowId);
+
+        if (!query->exec()) {
+            error = query->lastError();
+            m_db.rollback();
+            return i;
+        }
+        if (op.kind == OpKind::Insert) {
+            rowId = query->lastInsertId().toLongLong();
+            resolved.insert(op.ticket, rowId);
+        }
+        acks.append({op.ticket, rowId});
+    }
+
+    if (!m_db.commit()) {
+        error = m_db.lastError();
+        m_db.rollback();
+        return batch.size();
+    }
+    return -1;
+}
+
+// Makes freshly committed insert ids visible to the enqueue side and
+// rewrites queued writes that still refer to them by ticket.
+void WriteQueue::publishResolved(const QHash<qint64, qint64> &resolved)
+{
+    if (resolved.isEmpty()) return;
+    QMutexLocker lock(&m_mutex);
+    for (auto it = resolved.constBegin(); it != resolved.constEnd(); ++it)
+        m_resolved.insert(it.key(), it.value());
+    for (WriteOp &op : m_pending) {
+        if (op.kind != OpKind::Insert && op.record.id < 0)
+            op.record.id = resolved.value(-op.record.id, op.record.id);
+    }
+}
+
+bool WriteQueue::commitPending(bool lastAttempt)
+{
+    QList<WriteOp> batch;
+    QList<WriteAck> acks; // coalesced writes first, then this batch
+    {
+        QMutexLocker lock(&m_mutex);
+        batch.swap(m_pending);
+        acks.swap(m_coalesced);
+        m_timerArmed = false;
+        m_commitPosted = false;
+        m_retrying = false;
+    }
+    m_timer->stop();
+
+    QString error;
+    QList<qint64> failedTickets;
+    QList<qint64> inserted;
+    bool retry = false;
+
+    while (!batch.isEmpty()) {
+        QList<WriteAck> batchAcks;
+        QHash<qint64, qint64> resolved;
+        QSqlError sqlError;
+        const qsizetype failedAt = execBatch(batch, batchAcks, resolved, sqlError);
+        if (failedAt < 0) {
+            publishResolved(resolved);
+            inserted.append(resolved.keys());
+            acks.append(batchAcks);
+            break;
+        }
+
+        // SQLITE_BUSY and SQLITE_LOCKED (possibly as extended codes) clear
+        // up on their own once the other connection is done. Only
+        // SQLITE_TOOBIG, SQLITE_CONSTRAINT and SQLITE_MISMATCH are down to a
+        // single row; anything else fails the whole batch once, so a locked
+        // or broken database never costs a busy timeout per queued write.
+        const int code = sqlError.nativeErrorCode().toInt() & 0xff;
+        if ((code == 5 || code == 6) && !lastAttempt) {
+            retry = true;
+            break;
+        }
+        const bool rowError = code == 18 || code == 19 || code == 20;
+
+        error = sqlError.text();
+        if (failedAt == batch.size() || !rowError) {
+            for (const WriteOp &op : std::as_const(batch)) failedTickets.append(op.ticket);
+            batch.clear();
+        } else {
+            // Drop the write that cannot succeed and commit the rest without it.
+            failedTickets.append(batch.at(failedAt).ticket);
+            batch.removeAt(failedAt);
+        }
+    }
+
+    if (retry) {
+        m_retryDelay = qBound(MinRetryDelay, m_retryDelay * 2, MaxRetryDelay);
+        QMutexLocker lock(&m_mutex);
+        batch.append(m_pending);
+        m_pending.swap(batch);
+        m_retrying = true;
+        m_timer->start(m_retryDelay);
+    } else {
+        m_retryDelay = 0;
+    }
+
+    if (!acks.isEmpty()) emit committed(acks);
+    if (!failedTickets.isEmpty()) emit failed(error, failedTickets);
+
+    // Queued receivers get the acks before this runs on the queue's own
+    // thread, so by then nobody refers to these inserts by ticket any more.
+    if (!inserted.isEmpty()) {
+        QMetaObject::invokeMethod(this, [this, inserted] {
+            QMutexLocker lock(&m_mutex);
+            for (qint64 ticket : inserted) m_resolved.remove(ticket);
+        }, Qt::QueuedConnection);
+    }
+    return !retry;
+}
@@ -0,0 +1,105 @@
+#ifndef WRITEQUEUE_H
+#define WRITEQUEUE_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include "transactionrecord.h"
+
+class QThread;
+class QTimer;
+
+// Acknowledgment for one queued write, sent once its group commit is durable.
+// rowId is the database id the write ended up touching (0 if it was
+// coalesced away before reaching the database).
+struct WriteAck
+{
+    qint64 ticket = 0;
+    qint64 rowId = 0;
+};
+Q_DECLARE_METATYPE(WriteAck)
+
+// Coalesces inserts, updates and deletes on the transactions table and
+// commits them in groups on a dedicated thread with its own connection.
+// The enqueue functions are thread-safe and never touch the disk.
+//
+// A batch that hits a busy or locked database is put back at the head of
+// the queue and retried with growing delays. A constraint, type or size
+// error drops only the write that caused it and commits the rest of the
+// batch without it; any other error fails the whole batch. Dropped tickets
+// are reported through failed().
+class WriteQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WriteQueue(const QString &databaseName, QObject *parent = nullptr);
+    ~WriteQueue();
+
+    void setFlushInterval(int msec);
+    void setMaxBatchRows(int rows);
+
+    // Each returns the ticket of the write; a write folded into one that is
+    // still queued returns that write's ticket. For inserts, -ticket serves as
+    // the record id in later updates/deletes until receivers of committed()
+    // have seen the insert's ack and switched to the real id.
+    qint64 enqueueInsert(const TransactionRecord &record);
+    // Queues the records for one commit of their own, ahead of the flush
+    // interval. They get consecutive tickets starting at the returned one.
+    qint64 enqueueInsertBatch(const QList<TransactionRecord> &records);
+    qint64 enqueueUpdate(const TransactionRecord &record);
+    qint64 enqueueDelete(qint64 id);
+
+    // Blocks until everything queued so far has been committed, retrying a
+    // busy database a few times before reporting the writes as failed.
+    void flush();
+
+signals:
+    void committed(const QList<WriteAck> &acks);
+    void failed(const QString &error, const QList<qint64> &tickets);
+
+private:
+    enum class OpKind { Insert, Update, Delete };
+
+    struct WriteOp
+    {
+        OpKind kind;
+        qint64 ticket;
+        TransactionRecord record;
+    };
+
+    void scheduleCommitLocked();
+    void openConnection();
+    void closeConnection();
+    bool commitPending(bool lastAttempt = false);
+    qsizetype execBatch(const QList<WriteOp> &batch, QList<WriteAck> &acks,
+                        QHash<qint64, qint64> &resolved, QSqlError &error);
+    void publishResolved(const QHash<qint64, qint64> &resolved);
+    qint64 resolveLocked(qint64 id) const;
+
+    QString m_databaseName;
+    QString m_connectionName;
+    QThread *m_thread;
+    QObject *m_context; // lives in m_thread; target for worker-side calls
+    QTimer *m_timer;    // owned by m_context
+    int m_flushInterval;
+    int m_maxBatchRows;
+
+    QMutex m_mutex; // guards the fields below
+    QList<WriteOp> m_pending;
+    QList<WriteAck> m_coalesced;
+    qint64 m_nextTicket;
+    bool m_timerArmed;
+    bool m_commitPosted;
+    bool m_retrying;                  // a retry is scheduled; new writes wait for it
+    QHash<qint64, qint64> m_resolved; // insert ticket -> rowid, until the ack is delivered
+
+    // Worker thread only
+    QSqlDatabase m_db;
+    int m_retryDelay;
+};
+
+#endif // WRITEQUEUE_H